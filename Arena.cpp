@@ -0,0 +1,366 @@
+#include <cstdlib>
+#include <iostream>
+#include "Arena.h"
+#include "Glyphs.h"
+#include "Space.h"
+using namespace std;
+
+#define UP 'w'
+#define LEFT 'a'
+#define DOWN 's'
+#define RIGHT 'd'
+
+/* Parameterized Constructor
+ * Purpose: Creates an empty shared board of the given size.
+ * Parameters: y_dimen (vertical size of board), x_dimen (horizontal size of
+ *             board), seed (seed for spawn points and food placement)
+ * Returns: Nothing
+ */
+Arena::Arena(int y_dimen, int x_dimen, unsigned seed)
+        : rng(seed)
+{
+        if (y_dimen < 2 || x_dimen < 2) {
+                cerr << "Invalid Dimensions. Please choose dimensions "
+                     << "of size 2 or greater.\n";
+                exit(EXIT_FAILURE);
+        }
+
+        y_dimension = y_dimen;
+        x_dimension = x_dimen;
+        empty_count = y_dimension * x_dimension;
+        board.assign(empty_count, EMPTY);
+        dirty_mark.assign(empty_count, 0);
+        active_count = 0;
+}
+
+/* add_player()
+ * Purpose: Adds a new snake to the board at a random empty space, and adds
+ *          one more food so there is always something to chase.
+ * Parameters: None
+ * Returns: int (id of the new player, used by steer() and remove_player())
+ */
+int Arena::add_player()
+{
+        int id;
+        if (free_ids.empty()) {
+                id = players.size();
+                players.push_back(Player());
+        } else {
+                id = free_ids.back();
+                free_ids.pop_back();
+        }
+
+        Player &p = players[id];
+        p.active = true;
+        p.alive = false;
+        spawn(p);
+        active_count++;
+        bake_food();
+
+        return id;
+}
+
+/* remove_player()
+ * Purpose: Takes a snake off the board, along with the food add_player()
+ *          put out for it, and frees its id for reuse.
+ * Parameters: id (player to remove)
+ * Returns: void
+ */
+void Arena::remove_player(int id)
+{
+        Player &p = players[id];
+        if (!p.active) {
+                return;
+        }
+
+        kill(p);
+        take_food();
+        p.active = false;
+        active_count--;
+        free_ids.push_back(id);
+}
+
+/* steer()
+ * Purpose: Queues a direction for the player's next move. Like Game, a snake
+ *          can't be turned straight back onto itself. A key pressed by a
+ *          dead player respawns it instead.
+ * Parameters: id (player steering), key (one of 'w', 'a', 's' or 'd')
+ * Returns: void
+ */
+void Arena::steer(int id, char key)
+{
+        Player &p = players[id];
+        if (key != UP && key != DOWN && key != LEFT && key != RIGHT) {
+                return;
+        }
+        if (!p.alive) {
+                spawn(p);
+                return;
+        }
+
+        if ((p.direction == UP && key == DOWN) ||
+            (p.direction == DOWN && key == UP) ||
+            (p.direction == LEFT && key == RIGHT) ||
+            (p.direction == RIGHT && key == LEFT)) {
+                return;
+        }
+        p.pending = key;
+}
+
+/* tick()
+ * Purpose: Moves every living snake one space in its queued direction.
+ *          Snakes are moved in id order, so when two heads go for the same
+ *          space the lower id gets there first.
+ * Parameters: None
+ * Returns: void
+ */
+void Arena::tick()
+{
+        for (size_t i = 0; i < players.size(); i++) {
+                Player &p = players[i];
+                if (p.active && p.alive) {
+                        p.direction = p.pending;
+                        advance(p);
+                }
+        }
+}
+
+/* clear_changed()
+ * Purpose: Forgets the cells changed so far, starting a new delta.
+ * Parameters: None
+ * Returns: void
+ */
+void Arena::clear_changed()
+{
+        for (size_t i = 0; i < dirty.size(); i++) {
+                dirty_mark[dirty[i]] = 0;
+        }
+        dirty.clear();
+}
+
+/* render()
+ * Purpose: Draws the whole board from the top of the screen, in the same
+ *          layout as Game::print(), erasing runs of spaces rather than
+ *          sending them where that is shorter.
+ * Parameters: out (buffer to append the drawing to)
+ * Returns: void
+ */
+void Arena::render(string &out) const
+{
+        out += "\033[H";
+        encode_border('_', x_dimension + 2, out);
+        out += "\r\n";
+
+        for (int i = 0; i < y_dimension; i++) {
+                encode_border('|', 1, out);
+                encode_row(&board[i * x_dimension], x_dimension, out,
+                           RUN_ERASE);
+                encode_border('|', 1, out);
+                out += "\r\n";
+        }
+
+        encode_border('-', x_dimension + 2, out);
+        out += "\r\n";
+}
+
+/* render_cell()
+ * Purpose: Draws a single cell where the cursor is.
+ * Parameters: y, x (cell to draw), out (buffer to append the drawing to)
+ * Returns: void
+ */
+void Arena::render_cell(int y, int x, string &out) const
+{
+        encode_cell(cell(y, x), out);
+}
+
+/* set()
+ * Purpose: Changes a cell, recording it in the changed list and keeping the
+ *          count of empty spaces up to date.
+ * Parameters: y, x (cell to change), value (new Space for the cell)
+ * Returns: void
+ */
+void Arena::set(int y, int x, int value)
+{
+        int index = y * x_dimension + x;
+        if (board[index] == value) {
+                return;
+        }
+
+        empty_count += (value == EMPTY) - (board[index] == EMPTY);
+        board[index] = value;
+        if (!dirty_mark[index]) {
+                dirty_mark[index] = 1;
+                dirty.push_back(index);
+        }
+}
+
+/* spawn()
+ * Purpose: Places a player's head on a random empty space, standing still
+ *          until it is steered.
+ * Parameters: p (player to spawn)
+ * Returns: bool (false if the board had no room for it)
+ */
+bool Arena::spawn(Player &p)
+{
+        int y_rand, x_rand;
+        if (empty_count == 0) {
+                return false;
+        }
+
+        do {
+                y_rand = rng.below(y_dimension);
+                x_rand = rng.below(x_dimension);
+        } while (cell(y_rand, x_rand) != EMPTY);
+
+        p.alive = true;
+        p.y_head = p.y_tail = y_rand;
+        p.x_head = p.x_tail = x_rand;
+        p.snake_size = 1;
+        p.direction = p.pending = '\0';
+        set(y_rand, x_rand, HEAD);
+
+        return true;
+}
+
+/* kill()
+ * Purpose: Removes a player's snake from the board by walking from its tail
+ *          to its head.
+ * Parameters: p (player to remove from the board)
+ * Returns: void
+ */
+void Arena::kill(Player &p)
+{
+        if (!p.alive) {
+                return;
+        }
+
+        int y = p.y_tail, x = p.x_tail;
+        while (y != p.y_head || x != p.x_head) {
+                int value = cell(y, x);
+                set(y, x, EMPTY);
+                switch (value) {
+                        case BODY_FROM_UP:
+                                y--;
+                                break;
+                        case BODY_FROM_DOWN:
+                                y++;
+                                break;
+                        case BODY_FROM_LEFT:
+                                x--;
+                                break;
+                        case BODY_FROM_RIGHT:
+                                x++;
+                                break;
+                        default:
+                                // A damaged body; stop rather than wander
+                                y = p.y_head;
+                                x = p.x_head;
+                                break;
+                }
+        }
+        set(p.y_head, p.x_head, EMPTY);
+        p.alive = false;
+}
+
+/* advance()
+ * Purpose: Moves one snake a space in its current direction. Follows the
+ *          same rules as Game::move_up() and friends: hitting a wall or any
+ *          snake (including the space its own tail is about to leave) is
+ *          fatal, and eating food grows the snake by one.
+ * Parameters: p (player to move)
+ * Returns: void
+ */
+void Arena::advance(Player &p)
+{
+        int y = p.y_head, x = p.x_head;
+        int body;
+
+        switch (p.direction) {
+                case UP:
+                        y--;
+                        body = BODY_FROM_UP;
+                        break;
+                case DOWN:
+                        y++;
+                        body = BODY_FROM_DOWN;
+                        break;
+                case LEFT:
+                        x--;
+                        body = BODY_FROM_LEFT;
+                        break;
+                case RIGHT:
+                        x++;
+                        body = BODY_FROM_RIGHT;
+                        break;
+                default:
+                        return;
+        }
+
+        if (y < 0 || y >= y_dimension || x < 0 || x >= x_dimension ||
+            (cell(y, x) != EMPTY && cell(y, x) != FOOD)) {
+                kill(p);
+                return;
+        }
+
+        bool food = cell(y, x) == FOOD;
+        set(p.y_head, p.x_head, body);
+        if (!food) {
+                int tail = cell(p.y_tail, p.x_tail);
+                set(p.y_tail, p.x_tail, EMPTY);
+                p.y_tail += (tail == BODY_FROM_DOWN) - (tail == BODY_FROM_UP);
+                p.x_tail += (tail == BODY_FROM_RIGHT) -
+                            (tail == BODY_FROM_LEFT);
+        }
+        p.y_head = y;
+        p.x_head = x;
+        set(y, x, HEAD);
+
+        if (food) {
+                p.snake_size++;
+                bake_food();
+        }
+}
+
+/* bake_food()
+ * Purpose: Puts a food item on a random empty space, if there is one.
+ * Parameters: None
+ * Returns: void
+ */
+void Arena::bake_food()
+{
+        int y_rand, x_rand;
+        if (empty_count == 0) {
+                return;
+        }
+
+        do {
+                y_rand = rng.below(y_dimension);
+                x_rand = rng.below(x_dimension);
+        } while (cell(y_rand, x_rand) != EMPTY);
+
+        set(y_rand, x_rand, FOOD);
+}
+
+/* take_food()
+ * Purpose: Takes a food item off the board, if there is one, looking from a
+ *          random space so no corner of the board is always emptied first.
+ * Parameters: None
+ * Returns: void
+ */
+void Arena::take_food()
+{
+        int size = y_dimension * x_dimension;
+        int start = rng.below(size);
+        for (int i = 0; i < size; i++) {
+                int index = (start + i) % size;
+                if (board[index] == FOOD) {
+                        set(index / x_dimension, index % x_dimension, EMPTY);
+                        return;
+                }
+        }
+}
+
+#undef UP
+#undef LEFT
+#undef DOWN
+#undef RIGHT
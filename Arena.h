@@ -0,0 +1,73 @@
+#ifndef ARENA_H_
+#define ARENA_H_
+
+#include <string>
+#include <vector>
+#include "Rng.h"
+
+/* Arena
+ * A single board shared by any number of snakes. Uses the same cell
+ * encoding as Game, but every snake also remembers where its tail is so a
+ * move only touches the head and tail cells, and every cell that changes is
+ * recorded so callers can send out just the difference each tick.
+ */
+class Arena
+{
+        private:
+                struct Player {
+                        bool active;
+                        bool alive;
+                        int y_head;
+                        int x_head;
+                        int y_tail;
+                        int x_tail;
+                        int snake_size;
+                        char direction;
+                        char pending;
+                };
+
+                int y_dimension;
+                int x_dimension;
+                int empty_count;
+                std::vector<unsigned char> board;
+                std::vector<unsigned char> dirty_mark;
+                std::vector<int> dirty;
+                std::vector<Player> players;
+                std::vector<int> free_ids;
+                int active_count;
+                Rng rng;
+
+                void set(int y, int x, int value);
+                bool spawn(Player &p);
+                void kill(Player &p);
+                void advance(Player &p);
+                void bake_food();
+                void take_food();
+
+        public:
+                Arena(int y_dimen, int x_dimen, unsigned seed);
+
+                int add_player();
+                void remove_player(int id);
+                void steer(int id, char key);
+                void tick();
+
+                int height() const { return y_dimension; }
+                int width() const { return x_dimension; }
+                int cell(int y, int x) const
+                {
+                        return board[y * x_dimension + x];
+                }
+                int player_count() const { return active_count; }
+                int size_of(int id) const { return players[id].snake_size; }
+                bool alive(int id) const { return players[id].alive; }
+
+                void render(std::string &out) const;
+                void render_cell(int y, int x, std::string &out) const;
+
+                // Cells (as y * width + x) changed since clear_changed()
+                const std::vector<int> &changed() const { return dirty; }
+                void clear_changed();
+};
+
+#endif
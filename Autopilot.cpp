@@ -0,0 +1,131 @@
+#include <limits>
+#include "Autopilot.h"
+#include "Space.h"
+using namespace std;
+
+// Keys for the four directions, and the step each takes on the board
+static const char KEYS[] = { 'w', 'd', 's', 'a' };
+static const int Y_STEPS[] = { -1, 0, 1, 0 };
+static const int X_STEPS[] = { 0, 1, 0, -1 };
+
+/* Parameterized Constructor
+ * Purpose: Creates an Autopilot that plays by the given weights.
+ * Parameters: w (how much each part of a position's score counts)
+ * Returns: Nothing
+ */
+Autopilot::Autopilot(const Weights &w)
+{
+        weights = w;
+        mark = 0;
+}
+
+/* choose()
+ * Purpose: Picks the best move for a game: each direction the Snake can
+ *          take is played on a copy, and the one that scores best wins.
+ * Parameters: game (Game to pick a move for)
+ * Returns: char (key to steer with; the current direction if nothing
+ *          survives)
+ */
+char Autopilot::choose(const Game &game)
+{
+        char best = game.heading();
+        double best_score = -numeric_limits<double>::infinity();
+
+        for (int d = 0; d < 4; d++) {
+                trial = game;
+                if (KEYS[d] != game.heading() && !trial.steer(KEYS[d])) {
+                        continue;
+                }
+                trial.step();
+
+                double result;
+                if (trial.has_won()) {
+                        result = numeric_limits<double>::infinity();
+                } else if (trial.over()) {
+                        continue;
+                } else {
+                        result = score(trial, trial.size() > game.size());
+                }
+
+                if (result > best_score) {
+                        best_score = result;
+                        best = KEYS[d];
+                }
+        }
+
+        return best;
+}
+
+/* score()
+ * Purpose: Scores a position with one breadth-first search out from the
+ *          head, which finds the path to the nearest food, counts the
+ *          spaces the head can reach and notices if it reaches the tail.
+ * Parameters: game (position to score), ate (true if the move there ate,
+ *             which counts as being as close to food as can be)
+ * Returns: double (higher is better)
+ */
+double Autopilot::score(const Game &game, bool ate)
+{
+        int y_dimen = game.height();
+        int x_dimen = game.width();
+        int cells = y_dimen * x_dimen;
+
+        if ((int)seen.size() != cells) {
+                seen.assign(cells, 0);
+                distance.assign(cells, 0);
+                queue.resize(cells);
+        }
+        if (++mark == 0) {
+                seen.assign(cells, 0);
+                mark = 1;
+        }
+
+        int tail = game.tail_y() * x_dimen + game.tail_x();
+        int start = game.head_y() * x_dimen + game.head_x();
+        int food_distance = -1;
+        bool tail_reached = (tail == start);
+        int head_of_queue = 0, end_of_queue = 0;
+
+        queue[end_of_queue++] = start;
+        seen[start] = mark;
+        distance[start] = 0;
+
+        while (head_of_queue < end_of_queue) {
+                int at = queue[head_of_queue++];
+                int y = at / x_dimen, x = at % x_dimen;
+
+                for (int d = 0; d < 4; d++) {
+                        int ny = y + Y_STEPS[d], nx = x + X_STEPS[d];
+                        if (ny < 0 || ny >= y_dimen || nx < 0 ||
+                            nx >= x_dimen) {
+                                continue;
+                        }
+                        int next = ny * x_dimen + nx;
+                        if (next == tail) {
+                                tail_reached = true;
+                        }
+                        if (seen[next] == mark) {
+                                continue;
+                        }
+
+                        int cell = game.cells_in_row(ny)[nx];
+                        if (cell != EMPTY && cell != FOOD) {
+                                continue;
+                        }
+                        seen[next] = mark;
+                        distance[next] = distance[at] + 1;
+                        if (cell == FOOD && food_distance < 0) {
+                                food_distance = distance[next];
+                        }
+                        queue[end_of_queue++] = next;
+                }
+        }
+
+        double closeness = ate ? 1.0
+                           : (food_distance < 0) ? 0.0
+                           : 1.0 - (double)food_distance / cells;
+        double space = (double)(end_of_queue - 1) / cells;
+
+        return weights.food * closeness + weights.space * space +
+               weights.tail * (tail_reached ? 1.0 : 0.0);
+}
@@ -0,0 +1,42 @@
+#ifndef AUTOPILOT_H_
+#define AUTOPILOT_H_
+
+#include <vector>
+#include "Game.h"
+
+/* How much an Autopilot cares about each thing it looks at. */
+struct Weights {
+        double food;    // being close to food (by the path, not a line)
+        double space;   // how much of the board the head can still reach
+        double tail;    // whether the head can still reach the tail
+};
+
+/* Autopilot
+ * Picks moves for a Game with no one at the keyboard. Each way the Snake
+ * could go is tried on a copy of the game, and the result scored by a
+ * search out from the new head: how far it is to the nearest food, how
+ * many spaces can still be reached, and whether the tail can be (while it
+ * can, the Snake can always follow it round). The Weights decide how those
+ * add up. The copy and the search's storage are kept from move to move, so
+ * choosing a move allocates nothing.
+ */
+class Autopilot
+{
+        private:
+                Weights weights;
+                Game trial;
+                std::vector<int> queue;
+                std::vector<int> distance;
+                std::vector<unsigned> seen;     // == mark when visited
+                unsigned mark;
+
+                double score(const Game &game, bool ate);
+
+        public:
+                Autopilot(const Weights &w);
+
+                void set_weights(const Weights &w) { weights = w; }
+                char choose(const Game &game);
+};
+
+#endif
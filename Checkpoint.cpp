@@ -0,0 +1,431 @@
+#include <cstring>
+#include <ctime>
+#include <fcntl.h>
+#include <stdint.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "Checkpoint.h"
+#include "Game.h"
+#include "Space.h"
+using namespace std;
+
+// Bump SAVE_VERSION whenever SaveHeader or the cell encoding changes
+static const char SAVE_MAGIC[8] = { 'S', 'N', 'A', 'K', 'E', 'S', 'A', 'V' };
+static const uint32_t SAVE_VERSION = 1;
+
+/* Laid out so every field is naturally aligned, with no padding; files are
+ * written in the byte order of the machine that wrote them. */
+struct SaveHeader {
+        char magic[8];
+        uint32_t version;
+        uint32_t header_size;
+        int32_t y_dimension;
+        int32_t x_dimension;
+        int32_t y_head;
+        int32_t x_head;
+        int32_t y_tail;
+        int32_t x_tail;
+        int32_t empty_count;
+        int32_t food_count;
+        int32_t snake_size;
+        int32_t direction;
+        int32_t speed;
+        uint32_t flags;
+        uint64_t rng_state;
+        uint64_t checksum;
+};
+
+#define FLAG_GAME_OVER 1
+#define FLAG_WON 2
+
+/* checksum()
+ * Purpose: Hashes the cells of a save (FNV-1a, eight bytes at a time) so a
+ *          damaged file is noticed rather than loaded.
+ * Parameters: data (start of the cells), length (number of cells)
+ * Returns: uint64_t (the hash)
+ */
+static uint64_t checksum(const unsigned char *data, size_t length)
+{
+        uint64_t hash = 0xcbf29ce484222325ULL;
+        size_t i = 0;
+
+        for (; i + 8 <= length; i += 8) {
+                uint64_t word;
+                memcpy(&word, data + i, 8);
+                hash = (hash ^ word) * 0x100000001b3ULL;
+        }
+        for (; i < length; i++) {
+                hash = (hash ^ data[i]) * 0x100000001b3ULL;
+        }
+
+        return hash;
+}
+
+/* now_ms()
+ * Purpose: Reads the monotonic clock.
+ * Parameters: None
+ * Returns: long long (milliseconds since an arbitrary fixed point)
+ */
+static long long now_ms()
+{
+        timespec ts;
+        clock_gettime(CLOCK_MONOTONIC, &ts);
+        return ts.tv_sec * 1000LL + ts.tv_nsec / 1000000;
+}
+
+/* Parameterized Constructor
+ * Purpose: Starts the background writer for a save file.
+ * Parameters: file (path of the save file), interval_s (seconds between
+ *             the saves made by tick())
+ * Returns: Nothing
+ */
+Checkpoint::Checkpoint(const string &file, int interval_s)
+        : path(file)
+{
+        interval_ms = interval_s * 1000;
+        last_save = now_ms();
+        has_pending = false;
+        writing = false;
+        stopping = false;
+        writer = thread(&Checkpoint::write_loop, this);
+}
+
+/* Destructor
+ * Purpose: Finishes any save still waiting to be written and stops the
+ *          background writer.
+ * Parameters: None
+ * Returns: Nothing
+ */
+Checkpoint::~Checkpoint()
+{
+        {
+                lock_guard<mutex> guard(lock);
+                stopping = true;
+        }
+        wake.notify_one();
+        writer.join();
+}
+
+/* load()
+ * Purpose: Restores a game from the save file, if there is a valid one
+ *          for a board of the game's size and layout. The file is mapped
+ *          rather than read, and once checked its cells are copied
+ *          straight onto the board. The game is left alone otherwise.
+ * Parameters: game (Game to restore into)
+ * Returns: bool (true if a game was restored)
+ */
+bool Checkpoint::load(Game &game)
+{
+        int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd < 0) {
+                return false;
+        }
+
+        struct stat info;
+        if (fstat(fd, &info) < 0 ||
+            (size_t)info.st_size < sizeof(SaveHeader)) {
+                close(fd);
+                return false;
+        }
+
+        size_t length = info.st_size;
+        void *map = mmap(NULL, length, PROT_READ, MAP_PRIVATE, fd, 0);
+        close(fd);
+        if (map == MAP_FAILED) {
+                return false;
+        }
+        madvise(map, length, MADV_SEQUENTIAL);
+
+        const SaveHeader *header = (const SaveHeader *)map;
+        const unsigned char *cells = (const unsigned char *)map +
+                                     sizeof(SaveHeader);
+        bool valid = memcmp(header->magic, SAVE_MAGIC, 8) == 0 &&
+                     header->version == SAVE_VERSION &&
+                     header->header_size == sizeof(SaveHeader) &&
+                     header->y_dimension >= 2 && header->x_dimension >= 2 &&
+                     header->y_head >= 0 && header->x_head >= 0 &&
+                     header->y_head < header->y_dimension &&
+                     header->x_head < header->x_dimension &&
+                     header->y_tail >= 0 && header->x_tail >= 0 &&
+                     header->y_tail < header->y_dimension &&
+                     header->x_tail < header->x_dimension &&
+                     length - sizeof(SaveHeader) ==
+                     (size_t)header->y_dimension * header->x_dimension &&
+                     checksum(cells, length - sizeof(SaveHeader)) ==
+                     header->checksum &&
+                     consistent(*header, cells, game);
+
+        if (valid) {
+                for (int i = 0; i < game.y_dimension; i++) {
+                        memcpy(game.row(i),
+                               cells + (size_t)i * game.x_dimension,
+                               game.x_dimension);
+                }
+
+                game.head = game.index(header->y_head, header->x_head);
+                game.tail = game.index(header->y_tail, header->x_tail);
+                game.empty_count = header->empty_count;
+                game.food_count = header->food_count;
+                game.snake_size = header->snake_size;
+                game.direction = header->direction;
+                game.speed = header->speed;
+                game.game_over = header->flags & FLAG_GAME_OVER;
+                game.won = header->flags & FLAG_WON;
+                game.rng.state = header->rng_state;
+                game.index_food();
+        }
+
+        munmap(map, length);
+        return valid;
+}
+
+/* consistent()
+ * Purpose: Checks that a save describes a game that could really have
+ *          been played on this board, so nothing read from it can lead a
+ *          move or a drawing off the board: the same size and walls, only
+ *          known kinds of cell, a head where the head is said to be, a
+ *          body that leads from the tail to the head one cell at a time,
+ *          and counts of empty spaces, food and body that match the cells.
+ * Parameters: header (header of the save), cells (its cells, one byte
+ *             each, row by row), game (Game it is to be loaded into)
+ * Returns: bool (true if the save can be loaded into game)
+ */
+bool Checkpoint::consistent(const SaveHeader &header,
+                            const unsigned char *cells,
+                            const Game &game) const
+{
+        int y_dimen = header.y_dimension;
+        int x_dimen = header.x_dimension;
+        if (game.cells == NULL || game.y_dimension != y_dimen ||
+            game.x_dimension != x_dimen) {
+                return false;
+        }
+        if (header.direction != 'w' && header.direction != 'a' &&
+            header.direction != 's' && header.direction != 'd') {
+                return false;
+        }
+        if (header.speed < 1 || header.snake_size < 1) {
+                return false;
+        }
+
+        long long empty = 0, food = 0, body = 0;
+        for (int i = 0; i < y_dimen; i++) {
+                const unsigned char *saved = cells + (size_t)i * x_dimen;
+                const unsigned char *board = game.row(i);
+                for (int j = 0; j < x_dimen; j++) {
+                        if (saved[j] > WALL ||
+                            (saved[j] == WALL) != (board[j] == WALL)) {
+                                return false;
+                        }
+                        empty += (saved[j] == EMPTY);
+                        food += (saved[j] == FOOD);
+                        body += (saved[j] <= BODY_FROM_LEFT);
+                }
+        }
+        // The space a Snake first moves off stays body until it eats, so
+        // the Snake covers one space more than its size from then on
+        if (empty != header.empty_count || food != header.food_count ||
+            body < header.snake_size || body > header.snake_size + 1LL) {
+                return false;
+        }
+
+        // Walk from the tail to the head: each body cell says which side
+        // the next one towards the head is on
+        int y = header.y_tail, x = header.x_tail;
+        for (long long i = 1; i < body; i++) {
+                switch (cells[(size_t)y * x_dimen + x]) {
+                        case BODY_FROM_UP:
+                                y--;
+                                break;
+                        case BODY_FROM_RIGHT:
+                                x++;
+                                break;
+                        case BODY_FROM_DOWN:
+                                y++;
+                                break;
+                        case BODY_FROM_LEFT:
+                                x--;
+                                break;
+                        default:
+                                return false;
+                }
+                if (y < 0 || y >= y_dimen || x < 0 || x >= x_dimen) {
+                        return false;
+                }
+        }
+
+        return y == header.y_head && x == header.x_head &&
+               cells[(size_t)y * x_dimen + x] == HEAD;
+}
+
+/* tick()
+ * Purpose: Called after every move. Once the save interval has passed,
+ *          copies the game and leaves the background thread to write it. A
+ *          copy still waiting when the next is made is simply replaced.
+ * Parameters: game (Game to save)
+ * Returns: void
+ */
+void Checkpoint::tick(const Game &game)
+{
+        long long now = now_ms();
+        if (now - last_save < interval_ms) {
+                return;
+        }
+        last_save = now;
+
+        encode(game, scratch);
+        {
+                lock_guard<mutex> guard(lock);
+                pending.swap(scratch);
+                has_pending = true;
+        }
+        wake.notify_one();
+}
+
+/* save()
+ * Purpose: Writes the game to the save file before returning, after any
+ *          background save in progress has finished.
+ * Parameters: game (Game to save)
+ * Returns: void
+ */
+void Checkpoint::save(const Game &game)
+{
+        encode(game, scratch);
+
+        unique_lock<mutex> guard(lock);
+        has_pending = false;
+        written.wait(guard, [this] { return !writing; });
+        write_file(scratch);
+}
+
+/* discard()
+ * Purpose: Deletes the save file, e.g. once its game has ended, cancelling
+ *          any save not yet written.
+ * Parameters: None
+ * Returns: void
+ */
+void Checkpoint::discard()
+{
+        unique_lock<mutex> guard(lock);
+        has_pending = false;
+        written.wait(guard, [this] { return !writing; });
+        unlink(path.c_str());
+}
+
+/* encode()
+ * Purpose: Writes a game out in the save file format.
+ * Parameters: game (Game to encode), out (buffer to replace with the save)
+ * Returns: void
+ */
+void Checkpoint::encode(const Game &game, string &out) const
+{
+        size_t cells = (size_t)game.y_dimension * game.x_dimension;
+        out.resize(sizeof(SaveHeader) + cells);
+
+        SaveHeader header;
+        memset(&header, 0, sizeof(header));
+        memcpy(header.magic, SAVE_MAGIC, 8);
+        header.version = SAVE_VERSION;
+        header.header_size = sizeof(SaveHeader);
+        header.y_dimension = game.y_dimension;
+        header.x_dimension = game.x_dimension;
+        header.y_head = game.head / game.stride - 1;
+        header.x_head = game.head % game.stride - 1;
+        header.y_tail = game.tail / game.stride - 1;
+        header.x_tail = game.tail % game.stride - 1;
+        header.empty_count = game.empty_count;
+        header.food_count = game.food_count;
+        header.snake_size = game.snake_size;
+        header.direction = game.direction;
+        header.speed = game.speed;
+        header.flags = (game.game_over ? FLAG_GAME_OVER : 0) |
+                       (game.won ? FLAG_WON : 0);
+        header.rng_state = game.rng.state;
+
+        unsigned char *data = (unsigned char *)&out[sizeof(SaveHeader)];
+        for (int i = 0; i < game.y_dimension; i++) {
+                memcpy(data + (size_t)i * game.x_dimension, game.row(i),
+                       game.x_dimension);
+        }
+        header.checksum = checksum(data, cells);
+        memcpy(&out[0], &header, sizeof(header));
+}
+
+/* write_file()
+ * Purpose: Replaces the save file with new contents all at once: writes a
+ *          temporary file, flushes it to disk, then renames it over the
+ *          save.
+ * Parameters: data (new contents of the save file)
+ * Returns: bool (true on success)
+ */
+bool Checkpoint::write_file(const string &data) const
+{
+        string temp = path + ".tmp";
+        int fd = open(temp.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC,
+                      0644);
+        if (fd < 0) {
+                return false;
+        }
+
+        size_t done = 0;
+        while (done < data.size()) {
+                ssize_t n = write(fd, data.data() + done, data.size() - done);
+                if (n <= 0) {
+                        close(fd);
+                        unlink(temp.c_str());
+                        return false;
+                }
+                done += n;
+        }
+
+        if (fsync(fd) < 0 || close(fd) < 0 ||
+            rename(temp.c_str(), path.c_str()) < 0) {
+                unlink(temp.c_str());
+                return false;
+        }
+
+        // Make the rename itself stick
+        size_t slash = path.rfind('/');
+        string dir = (slash == string::npos) ? "." : path.substr(0, slash + 1);
+        int dir_fd = open(dir.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+        if (dir_fd >= 0) {
+                fsync(dir_fd);
+                close(dir_fd);
+        }
+
+        return true;
+}
+
+/* write_loop()
+ * Purpose: Body of the background writer: waits for tick() to hand over a
+ *          copy of the game, and writes it.
+ * Parameters: None
+ * Returns: void
+ */
+void Checkpoint::write_loop()
+{
+        string data;
+        unique_lock<mutex> guard(lock);
+
+        while (true) {
+                wake.wait(guard, [this] { return stopping || has_pending; });
+                if (!has_pending) {
+                        return;
+                }
+
+                data.swap(pending);
+                has_pending = false;
+                writing = true;
+                guard.unlock();
+
+                write_file(data);
+
+                guard.lock();
+                writing = false;
+                written.notify_all();
+        }
+}
+
+#undef FLAG_GAME_OVER
+#undef FLAG_WON
@@ -0,0 +1,62 @@
+#ifndef CHECKPOINT_H_
+#define CHECKPOINT_H_
+
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include <thread>
+
+class Game;
+struct SaveHeader;
+
+/* Checkpoint
+ * Saves a Game to a file so it can be picked up again later. The file is a
+ * fixed header (board size, head and tail, direction, speed, size, random
+ * number state) followed by one byte per cell, and is always replaced whole
+ * by writing a temporary file and renaming it over the old one, so a crash
+ * part way through never leaves a broken save behind.
+ *
+ * tick() takes a copy of the game every so often and hands it to a
+ * background thread to write, so the game never waits on the disk. save()
+ * writes straight away, for when the game is about to exit. load() maps the
+ * file into memory rather than reading it, so even huge boards resume
+ * quickly. A save is only loaded into a Game of the same size and layout,
+ * and only once every cell, the Snake and the counts have been checked
+ * against each other, so a damaged or edited file is turned away rather
+ * than played.
+ */
+class Checkpoint
+{
+        private:
+                std::string path;
+                int interval_ms;
+                long long last_save;
+
+                std::mutex lock;
+                std::condition_variable wake;
+                std::condition_variable written;
+                std::string pending;            // waiting to be written
+                std::string scratch;            // next copy is made here
+                bool has_pending;
+                bool writing;
+                bool stopping;
+                std::thread writer;
+
+                void encode(const Game &game, std::string &out) const;
+                bool consistent(const SaveHeader &header,
+                                const unsigned char *cells,
+                                const Game &game) const;
+                bool write_file(const std::string &data) const;
+                void write_loop();
+
+        public:
+                Checkpoint(const std::string &file, int interval_s);
+                ~Checkpoint();
+
+                bool load(Game &game);
+                void tick(const Game &game);
+                void save(const Game &game);
+                void discard();
+};
+
+#endif
@@ -0,0 +1,499 @@
+#include <algorithm>
+#include <cstdlib>
+#include <thread>
+#include <vector>
+#include "Differ.h"
+#include "Game.h"
+#include "Reference.h"
+#include "Space.h"
+using namespace std;
+
+// Games a thread takes at a time
+static const long long BATCH = 64;
+
+// Random smaller games tried when shrinking a failure
+static const int SEARCH = 20000;
+
+// Moves between swapping the Game for a copy of itself
+static const int COPY_EVERY = 8;
+
+/* nearest_food()
+ * Purpose: Finds how far the Reference's nearest food is from its head, by
+ *          looking at every cell, to check Game's food index against.
+ * Parameters: reference (engine to look at), y_dimension, x_dimension
+ *             (size of its board)
+ * Returns: int (moves to the nearest food, or -1 if there is none)
+ */
+static int nearest_food(const Reference &reference, int y_dimension,
+                        int x_dimension)
+{
+        int best = -1;
+        for (int i = 0; i < y_dimension; i++) {
+                for (int j = 0; j < x_dimension; j++) {
+                        int d = abs(i - reference.head_y()) +
+                                abs(j - reference.head_x());
+                        if (reference.cell(i, j) == FOOD &&
+                            (best < 0 || d < best)) {
+                                best = d;
+                        }
+                }
+        }
+        return best;
+}
+
+/* compare()
+ * Purpose: Compares a Game with the Reference playing the same game,
+ *          including how far Game's food index says the nearest food is.
+ * Parameters: game, reference (the two engines), why (set to the first
+ *             difference found)
+ * Returns: bool (true if they are the same)
+ */
+static bool compare(const Game &game, const Reference &reference,
+                    string &why)
+{
+        if (game.over() != reference.over() ||
+            game.has_won() != reference.has_won()) {
+                why = string("game is ") +
+                      (game.over() ? (game.has_won() ? "won" : "lost")
+                                   : "going") +
+                      " in Game but " +
+                      (reference.over() ? (reference.has_won() ? "won"
+                                                               : "lost")
+                                        : "going") +
+                      " in Reference";
+                return false;
+        }
+        if (game.size() != reference.size()) {
+                why = "size is " + to_string(game.size()) + " in Game but " +
+                      to_string(reference.size()) + " in Reference";
+                return false;
+        }
+        if (game.heading() != reference.heading()) {
+                why = string("heading is '") + (char)game.heading() +
+                      "' in Game but '" + (char)reference.heading() +
+                      "' in Reference";
+                return false;
+        }
+        if (game.delay() != reference.delay()) {
+                why = "delay is " + to_string(game.delay()) +
+                      " in Game but " + to_string(reference.delay()) +
+                      " in Reference";
+                return false;
+        }
+        if (!game.over() && (game.head_y() != reference.head_y() ||
+                             game.head_x() != reference.head_x())) {
+                why = "head is at (" + to_string(game.head_y()) + ", " +
+                      to_string(game.head_x()) + ") in Game but (" +
+                      to_string(reference.head_y()) + ", " +
+                      to_string(reference.head_x()) + ") in Reference";
+                return false;
+        }
+
+        for (int i = 0; i < game.height(); i++) {
+                const unsigned char *cells = game.cells_in_row(i);
+                for (int j = 0; j < game.width(); j++) {
+                        if (cells[j] != reference.cell(i, j)) {
+                                why = "cell (" + to_string(i) + ", " +
+                                      to_string(j) + ") is " +
+                                      to_string(cells[j]) + " in Game but " +
+                                      to_string(reference.cell(i, j)) +
+                                      " in Reference";
+                                return false;
+                        }
+                }
+        }
+
+        int food_y, food_x;
+        int indexed = game.nearest_food(game.head_y(), game.head_x(), food_y,
+                                        food_x)
+                      ? abs(food_y - game.head_y()) +
+                        abs(food_x - game.head_x())
+                      : -1;
+        int scanned = nearest_food(reference, game.height(), game.width());
+        if (indexed != scanned) {
+                why = "nearest food is " + to_string(indexed) +
+                      " moves away in Game but " + to_string(scanned) +
+                      " in Reference";
+                return false;
+        }
+
+        return true;
+}
+
+/* safe()
+ * Purpose: Checks whether the Snake would live through its next move if a
+ *          key were pressed.
+ * Parameters: game (game being played), key (key to try)
+ * Returns: bool (true if the move lands on an empty space or food)
+ */
+static bool safe(const Game &game, char key)
+{
+        static const char OPPOSITE[][2] = {
+                { 'w', 's' }, { 's', 'w' }, { 'a', 'd' }, { 'd', 'a' }
+        };
+        char heading = game.heading();
+        if (key == 'w' || key == 'a' || key == 's' || key == 'd') {
+                heading = key;
+                for (int i = 0; i < 4; i++) {
+                        if (OPPOSITE[i][0] == key &&
+                            OPPOSITE[i][1] == game.heading()) {
+                                heading = game.heading();
+                        }
+                }
+        }
+
+        int y = game.head_y() + (heading == 's') - (heading == 'w');
+        int x = game.head_x() + (heading == 'd') - (heading == 'a');
+        if (y < 0 || y >= game.height() || x < 0 || x >= game.width()) {
+                return false;
+        }
+        int cell = game.cells_in_row(y)[x];
+        return cell == EMPTY || cell == FOOD;
+}
+
+/* choose()
+ * Purpose: Picks the next key for a random game: half the time the way
+ *          towards the nearest food, most of the rest a random direction,
+ *          and otherwise no key or one that is not a direction. A key that
+ *          would kill the Snake is usually swapped for one that would not,
+ *          so games last long enough to speed up and to fill small boards.
+ * Parameters: game (game being played), rng (where the choices come from)
+ * Returns: char (key to press, or '\0' for none)
+ */
+static char choose(const Game &game, Rng &rng)
+{
+        static const char DIRECTIONS[] = { 'w', 'a', 's', 'd' };
+        int roll = rng.below(100);
+        int food_y, food_x;
+        char key;
+
+        if (roll < 50 && game.nearest_food(game.head_y(), game.head_x(),
+                                           food_y, food_x)) {
+                int dy = food_y - game.head_y(), dx = food_x - game.head_x();
+                if (dy != 0 && (dx == 0 || rng.below(2) == 0)) {
+                        key = dy < 0 ? 'w' : 's';
+                } else {
+                        key = dx < 0 ? 'a' : 'd';
+                }
+        } else if (roll < 90) {
+                key = DIRECTIONS[rng.below(4)];
+        } else {
+                key = roll < 95 ? '\0' : 'x';
+        }
+
+        if (!safe(game, key) && rng.below(16) != 0) {
+                int first = rng.below(4);
+                for (int i = 0; i < 4; i++) {
+                        char other = DIRECTIONS[(first + i) % 4];
+                        if (safe(game, other)) {
+                                return other;
+                        }
+                }
+        }
+        return key;
+}
+
+/* Parameterized Constructor
+ * Purpose: Sets up the games to play.
+ * Parameters: seed (which games; the same seed plays the same games), rows,
+ *             cols (largest board), moves (moves after which a game is
+ *             stopped)
+ * Returns: Nothing
+ */
+Differ::Differ(uint64_t seed, int rows, int cols, int moves)
+{
+        base_seed = seed;
+        max_rows = max(rows, 2);
+        max_cols = max(cols, 2);
+        max_moves = moves;
+        next_game = 0;
+        games_played = 0;
+        moves_played = 0;
+        found = false;
+}
+
+/* run()
+ * Purpose: Plays games on a pool of threads until they have all been
+ *          played or one goes differently on the two engines.
+ * Parameters: games (how many to play), threads (size of the pool)
+ * Returns: bool (true if every game went the same; otherwise see failed())
+ */
+bool Differ::run(long long games, int threads)
+{
+        vector<thread> pool;
+        for (int i = 0; i < max(threads, 1); i++) {
+                pool.push_back(thread(&Differ::work, this, games));
+        }
+        for (size_t i = 0; i < pool.size(); i++) {
+                pool[i].join();
+        }
+        return !found;
+}
+
+/* work()
+ * Purpose: Body of a pool thread: plays batches of games until there are
+ *          none left or a difference has been found.
+ * Parameters: games (total games to play)
+ * Returns: void
+ */
+void Differ::work(long long games)
+{
+        Trace trace;
+        string why;
+
+        while (!found) {
+                long long first = next_game.fetch_add(BATCH);
+                if (first >= games) {
+                        return;
+                }
+
+                long long last = min(first + BATCH, games);
+                long long moves = 0;
+                for (long long i = first; i < last && !found; i++) {
+                        Rng keys(base_seed * 0x100000001B3ULL + i);
+                        pick(keys, trace);
+                        bool differs = play(trace, &keys, max_moves,
+                                            why) >= 0;
+                        moves += trace.keys.size();
+
+                        if (differs) {
+                                lock_guard<mutex> guard(lock);
+                                if (!found) {
+                                        failure = trace;
+                                        found = true;
+                                }
+                        }
+                }
+                games_played += last - first;
+                moves_played += moves;
+        }
+}
+
+/* pick()
+ * Purpose: Picks a random game: its board size, food rules and seed.
+ * Parameters: rng (where the choices come from), trace (set to the game,
+ *             with no keys yet)
+ * Returns: void
+ */
+void Differ::pick(Rng &rng, Trace &trace) const
+{
+        static const int FIXED[][2] = { { 10, 40 }, { 20, 80 }, { 24, 80 } };
+        int kind = rng.below(8);
+
+        if (kind < 3 && FIXED[kind][0] <= max_rows &&
+            FIXED[kind][1] <= max_cols) {
+                trace.y_dimension = FIXED[kind][0];
+                trace.x_dimension = FIXED[kind][1];
+        } else if (kind < 6) {
+                // Small enough to be won now and then
+                trace.y_dimension = 2 + rng.below(min(max_rows, 6) - 1);
+                trace.x_dimension = 2 + rng.below(min(max_cols, 6) - 1);
+        } else {
+                trace.y_dimension = 2 + rng.below(max_rows - 1);
+                trace.x_dimension = 2 + rng.below(max_cols - 1);
+        }
+
+        trace.food_at_once = rng.below(4) == 0 ? 1 + rng.below(4) : 1;
+        trace.seed = (uint64_t)rng.next() << 32 | rng.next();
+        trace.keys.clear();
+}
+
+/* play()
+ * Purpose: Plays a game on both engines, comparing them after the food is
+ *          first put out and after every move.
+ * Parameters: trace (game to play; with keys NULL, its keys are pressed in
+ *             turn), keys (if not NULL, where to draw keys from instead;
+ *             each one is added to trace), limit (most moves to draw),
+ *             why (set to the first difference found)
+ * Returns: int (keys pressed before the engines differed, or -1 if they
+ *          never did)
+ */
+int Differ::play(Trace &trace, Rng *keys, int limit, string &why)
+{
+        Game game(trace.y_dimension, trace.x_dimension);
+        Reference reference(trace.y_dimension, trace.x_dimension);
+        game.seed(trace.seed);
+        reference.seed(trace.seed);
+        game.set_food_at_once(trace.food_at_once);
+        reference.set_food_at_once(trace.food_at_once);
+        game.start();
+        reference.start();
+        if (!compare(game, reference, why)) {
+                why = "after start: " + why;
+                return 0;
+        }
+
+        int moves = (keys != NULL) ? limit : trace.keys.size();
+        for (int t = 0; t < moves && !game.over(); t++) {
+                char key;
+                if (keys != NULL) {
+                        key = choose(game, *keys);
+                        trace.keys += key;
+                } else {
+                        key = trace.keys[t];
+                }
+
+                bool turned = (t == 0) ? game.begin(key) : game.steer(key);
+                bool reference_turned = (t == 0) ? reference.begin(key)
+                                                 : reference.steer(key);
+                game.step();
+                reference.step();
+
+                // Go on from a copy now and then, so a copy that loses
+                // anything shows up as a difference. Every other time the
+                // Game is first made a different size, so assigning the
+                // copy back has to make a new board too.
+                if (t % COPY_EVERY == COPY_EVERY - 1) {
+                        Game copy(game);
+                        if (t / COPY_EVERY % 2 == 1) {
+                                game = Game(2, 2);
+                        }
+                        game = copy;
+                }
+
+                if (turned != reference_turned) {
+                        why = string("key '") + key + "' was " +
+                              (turned ? "taken" : "ignored") +
+                              " by Game but " +
+                              (reference_turned ? "taken" : "ignored") +
+                              " by Reference";
+                } else if (compare(game, reference, why)) {
+                        continue;
+                }
+                why = "move " + to_string(t + 1) + ": " + why;
+                return t + 1;
+        }
+
+        return -1;
+}
+
+/* still_fails()
+ * Purpose: Checks whether a trace still makes the engines differ.
+ * Parameters: trace (game to play)
+ * Returns: bool (true if it does)
+ */
+bool Differ::still_fails(const Trace &trace) const
+{
+        Trace copy = trace;
+        string why;
+        return play(copy, NULL, 0, why) >= 0;
+}
+
+/* shrink()
+ * Purpose: Makes a trace that makes the engines differ as small as it can
+ *          while it still fails. Dropping a move changes where the Snake
+ *          goes and so what it eats, so on its own that seldom gets far;
+ *          random games on no bigger a board and in fewer moves are tried
+ *          first, and any that fails is taken instead. Then the result is
+ *          cut down move by move.
+ * Parameters: trace (failing game; replaced with the smallest found)
+ * Returns: void
+ */
+void Differ::shrink(Trace &trace) const
+{
+        search(trace);
+        reduce(trace);
+}
+
+/* search()
+ * Purpose: Plays random games no bigger than a failing one, and keeps any
+ *          that fails sooner, or as soon on a smaller board.
+ * Parameters: trace (failing game; replaced with the smallest found)
+ * Returns: void
+ */
+void Differ::search(Trace &trace) const
+{
+        Rng rng(trace.seed);
+        Trace candidate;
+        string why;
+
+        for (int i = 0; i < SEARCH && trace.keys.size() > 1; i++) {
+                candidate.y_dimension = 2 + rng.below(trace.y_dimension - 1);
+                candidate.x_dimension = 2 + rng.below(trace.x_dimension - 1);
+                candidate.food_at_once = 1 + rng.below(trace.food_at_once);
+                candidate.seed = (uint64_t)rng.next() << 32 | rng.next();
+                candidate.keys.clear();
+
+                int at = play(candidate, &rng, trace.keys.size(), why);
+                if (at < 0) {
+                        continue;
+                }
+                candidate.keys.resize(at);
+                if (candidate.keys.size() < trace.keys.size() ||
+                    (candidate.keys.size() == trace.keys.size() &&
+                     candidate.y_dimension * candidate.x_dimension <
+                     trace.y_dimension * trace.x_dimension)) {
+                        trace = candidate;
+                }
+        }
+}
+
+/* reduce()
+ * Purpose: Cuts down a failing trace, keeping it failing: keys after the
+ *          difference are dropped, then runs of moves, then single keys
+ *          are blanked, then the board and the food at once are made
+ *          smaller, over and over until nothing more can go.
+ * Parameters: trace (failing game; replaced with the smallest found)
+ * Returns: void
+ */
+void Differ::reduce(Trace &trace) const
+{
+        string why;
+        bool smaller = true;
+
+        while (smaller) {
+                smaller = false;
+                int at = play(trace, NULL, 0, why);
+                if (at < 0) {
+                        return;
+                }
+                trace.keys.resize(at);
+
+                // Drop runs of moves, halving the run length each pass
+                for (size_t run = max(trace.keys.size() / 2, (size_t)1);
+                     run > 0; run /= 2) {
+                        for (size_t start = 0;
+                             start + run <= trace.keys.size();) {
+                                Trace candidate = trace;
+                                candidate.keys.erase(start, run);
+                                if (still_fails(candidate)) {
+                                        trace = candidate;
+                                        smaller = true;
+                                } else {
+                                        start += run;
+                                }
+                        }
+                }
+
+                // Blank single keys
+                for (size_t i = 0; i < trace.keys.size(); i++) {
+                        if (trace.keys[i] == '\0') {
+                                continue;
+                        }
+                        Trace candidate = trace;
+                        candidate.keys[i] = '\0';
+                        if (still_fails(candidate)) {
+                                trace = candidate;
+                                smaller = true;
+                        }
+                }
+
+                // Smaller boards and less food
+                for (int i = 0; i < 3; i++) {
+                        Trace candidate = trace;
+                        if (i == 0 && trace.y_dimension > 2) {
+                                candidate.y_dimension--;
+                        } else if (i == 1 && trace.x_dimension > 2) {
+                                candidate.x_dimension--;
+                        } else if (i == 2 && trace.food_at_once > 1) {
+                                candidate.food_at_once--;
+                        } else {
+                                continue;
+                        }
+                        if (still_fails(candidate)) {
+                                trace = candidate;
+                                smaller = true;
+                        }
+                }
+        }
+}
@@ -0,0 +1,73 @@
+#ifndef DIFFER_H_
+#define DIFFER_H_
+
+#include <atomic>
+#include <mutex>
+#include <string>
+#include "Rng.h"
+
+class Game;
+class Reference;
+
+/* Everything needed to play a game again exactly: the board, the food
+ * rules, the seed for the food, and the key pressed before each move
+ * ('\0' for none). The first key starts the Snake. */
+struct Trace {
+        uint64_t seed;
+        int y_dimension;
+        int x_dimension;
+        int food_at_once;
+        std::string keys;
+};
+
+/* Differ
+ * Plays random games on Game and on the frozen Reference side by side,
+ * with the same seed and the same keys, and compares the two after every
+ * move: every cell of the board, the head, the heading, the size, the
+ * speed, and whether the game is over or won. Keys are half random and
+ * half steering for the nearest food, so Snakes grow long enough to run
+ * into themselves and, on small boards, to win. Board sizes are random,
+ * with the sizes Game has special code for (10x40, 20x80, 24x80) played
+ * often.
+ *
+ * run() spreads the games over a pool of threads, each taking games a
+ * batch at a time, and stops at the first game that goes differently.
+ * shrink() then looks for the smallest game that still shows a
+ * difference: first by playing random games that are smaller, then by
+ * dropping moves, blanking keys and shrinking the board one by one.
+ */
+class Differ
+{
+        private:
+                uint64_t base_seed;
+                int max_rows;
+                int max_cols;
+                int max_moves;
+
+                std::atomic<long long> next_game;
+                std::atomic<long long> games_played;
+                std::atomic<long long> moves_played;
+                std::atomic<bool> found;
+                std::mutex lock;
+                Trace failure;
+
+                void work(long long games);
+                void pick(Rng &rng, Trace &trace) const;
+                bool still_fails(const Trace &trace) const;
+                void search(Trace &trace) const;
+                void reduce(Trace &trace) const;
+
+        public:
+                Differ(uint64_t seed, int rows, int cols, int moves);
+
+                bool run(long long games, int threads);
+                long long played() const { return games_played; }
+                long long moves() const { return moves_played; }
+                const Trace &failed() const { return failure; }
+
+                static int play(Trace &trace, Rng *keys, int limit,
+                                std::string &why);
+                void shrink(Trace &trace) const;
+};
+
+#endif
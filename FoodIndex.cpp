@@ -0,0 +1,152 @@
+#include <cstdlib>
+#include "FoodIndex.h"
+using namespace std;
+
+/* Constructor
+ * Purpose: Creates an index for an empty board with no cells.
+ * Parameters: None
+ * Returns: Nothing
+ */
+FoodIndex::FoodIndex()
+{
+        y_dimension = 0;
+        x_dimension = 0;
+        buckets_y = 0;
+        buckets_x = 0;
+        count = 0;
+}
+
+/* resize()
+ * Purpose: Empties the index and sets it up for a board of a new size.
+ * Parameters: y_dimen, x_dimen (size of the board)
+ * Returns: void
+ */
+void FoodIndex::resize(int y_dimen, int x_dimen)
+{
+        y_dimension = y_dimen;
+        x_dimension = x_dimen;
+        buckets_y = ((y_dimen - 1) >> SHIFT) + 1;
+        buckets_x = ((x_dimen - 1) >> SHIFT) + 1;
+        count = 0;
+        buckets.assign((size_t)buckets_y * buckets_x, vector<int>());
+}
+
+/* clear()
+ * Purpose: Removes all the food, keeping the memory for the next game.
+ * Parameters: None
+ * Returns: void
+ */
+void FoodIndex::clear()
+{
+        for (size_t b = 0; b < buckets.size() && count > 0; b++) {
+                count -= buckets[b].size();
+                buckets[b].clear();
+        }
+}
+
+/* insert()
+ * Purpose: Records food at a cell. Food already recorded there is left be.
+ * Parameters: y, x (cell the food is on)
+ * Returns: void
+ */
+void FoodIndex::insert(int y, int x)
+{
+        int cell = y * x_dimension + x;
+        vector<int> &bucket = buckets[bucket_of(y, x)];
+        if (find(bucket, cell) >= 0) {
+                return;
+        }
+
+        bucket.push_back(cell);
+        count++;
+}
+
+/* remove()
+ * Purpose: Forgets the food at a cell, by moving the last food in its
+ *          bucket into its place.
+ * Parameters: y, x (cell the food was on)
+ * Returns: void
+ */
+void FoodIndex::remove(int y, int x)
+{
+        int cell = y * x_dimension + x;
+        vector<int> &bucket = buckets[bucket_of(y, x)];
+        int at = find(bucket, cell);
+        if (at < 0) {
+                return;
+        }
+
+        bucket[at] = bucket.back();
+        bucket.pop_back();
+        count--;
+}
+
+/* find()
+ * Purpose: Looks for a cell in a bucket's list.
+ * Parameters: bucket (list to look in), cell (cell, as y * x + x)
+ * Returns: int (its place in the list, or -1 if it isn't there)
+ */
+int FoodIndex::find(const vector<int> &bucket, int cell) const
+{
+        for (size_t i = 0; i < bucket.size(); i++) {
+                if (bucket[i] == cell) {
+                        return i;
+                }
+        }
+        return -1;
+}
+
+/* nearest()
+ * Purpose: Finds the food fewest moves from a cell.
+ * Parameters: y, x (cell to measure from), food_y, food_x (set to the
+ *             nearest food, if there is any)
+ * Returns: bool (false if there is no food at all)
+ */
+bool FoodIndex::nearest(int y, int x, int &food_y, int &food_x) const
+{
+        if (count == 0) {
+                return false;
+        }
+
+        int by = y >> SHIFT, bx = x >> SHIFT;
+        int rings = max(max(by, buckets_y - 1 - by),
+                        max(bx, buckets_x - 1 - bx));
+        int best = -1;
+
+        for (int r = 0; r <= rings; r++) {
+                for (int i = by - r; i <= by + r; i++) {
+                        if (i < 0 || i >= buckets_y) {
+                                continue;
+                        }
+                        // Whole rows at the top and bottom of the ring, just
+                        // the two ends of the rows between
+                        bool edge = (i == by - r || i == by + r);
+                        int step = (edge || r == 0) ? 1 : 2 * r;
+
+                        for (int j = bx - r; j <= bx + r; j += step) {
+                                if (j < 0 || j >= buckets_x) {
+                                        continue;
+                                }
+                                const vector<int> &bucket =
+                                        buckets[i * buckets_x + j];
+                                for (size_t k = 0; k < bucket.size(); k++) {
+                                        int fy = bucket[k] / x_dimension;
+                                        int fx = bucket[k] % x_dimension;
+                                        int d = abs(fy - y) + abs(fx - x);
+                                        if (best < 0 || d < best) {
+                                                best = d;
+                                                food_y = fy;
+                                                food_x = fx;
+                                        }
+                                }
+                        }
+                }
+
+                // Anything in the next ring is at least this far away
+                if (best >= 0 && best <= (r << SHIFT)) {
+                        break;
+                }
+        }
+
+        return true;
+}
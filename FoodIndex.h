@@ -0,0 +1,48 @@
+#ifndef FOODINDEX_H_
+#define FOODINDEX_H_
+
+#include <vector>
+
+/* FoodIndex
+ * Where the food is on a board, for finding the nearest piece without
+ * looking at every cell. The board is split into square buckets, each with
+ * a list of the food inside it. A bucket holds at most 64 cells, so adding
+ * or removing food just looks through its list; nothing is kept per cell,
+ * and an index costs next to nothing beside its board. A nearest
+ * query looks at buckets in rings spreading out from the one it starts in,
+ * and stops as soon as no further ring could hold anything closer.
+ *
+ * Distances are counted in moves (up, down, left, right), ignoring
+ * anything in the way.
+ */
+class FoodIndex
+{
+        private:
+                // Buckets are 1 << SHIFT cells square
+                static const int SHIFT = 3;
+
+                int y_dimension;
+                int x_dimension;
+                int buckets_y;
+                int buckets_x;
+                int count;
+                std::vector<std::vector<int> > buckets; // cells, as y * x + x
+
+                int bucket_of(int y, int x) const
+                {
+                        return (y >> SHIFT) * buckets_x + (x >> SHIFT);
+                }
+                int find(const std::vector<int> &bucket, int cell) const;
+
+        public:
+                FoodIndex();
+
+                void resize(int y_dimen, int x_dimen);
+                void clear();
+                void insert(int y, int x);
+                void remove(int y, int x);
+                int size() const { return count; }
+                bool nearest(int y, int x, int &food_y, int &food_x) const;
+};
+
+#endif
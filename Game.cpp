@@ -1,7 +1,16 @@
+#include <algorithm>
+#include <atomic>
+#include <ctime>
 #include <iostream>
 #include <cstdlib>
+#include "Checkpoint.h"
 #include "Game.h"
+#include "Glyphs.h"
+#include "Level.h"
+#include "Scores.h"
+#include "Space.h"
 #include "termfuncs.h"
+#include <sys/random.h>
 #include <unistd.h>
 using namespace std;
 
@@ -10,30 +19,48 @@ using namespace std;
 #define DOWN 's'
 #define RIGHT 'd'
 
-// Different terminal escape characters for modifying text appearances
-#define NORMAL "\033[0m"
-#define BOLD "\033[1m"
-
-#define RED_TEXT "\033[31m"
-#define GREEN_TEXT "\033[32m"
-#define YELLOW_TEXT "\033[33m"
-#define BLUE_TEXT "\033[34m"
-#define MAGENTA_TEXT "\033[35m"
-#define CYAN_TEXT "\033[36m"
-#define WHITE_TEXT "\033[37m"
-
-#define RED_BACKGROUND "\033[41m"
-#define GREEN_BACKGROUND "\033[42m"
-#define YELLOW_BACKGROUND "\033[43m"
-#define BLUE_BACKGROUND "\033[44m"
-#define MAGENTA_BACKGROUND "\033[45m"
-#define CYAN_BACKGROUND "\033[46m"
-#define WHITE_BACKGROUND "\033[47m"
-
-typedef enum Space {
-        HEAD = 0, BODY_FROM_UP, BODY_FROM_RIGHT, BODY_FROM_DOWN, 
-        BODY_FROM_LEFT, EMPTY, FOOD
-} Space;
+// The body Space a move leaves behind, indexed by direction key; HEAD if the
+// key is not a direction
+static const struct Headings {
+        unsigned char of[256];
+        constexpr Headings() : of()
+        {
+                of[UP] = BODY_FROM_UP;
+                of[RIGHT] = BODY_FROM_RIGHT;
+                of[DOWN] = BODY_FROM_DOWN;
+                of[LEFT] = BODY_FROM_LEFT;
+        }
+        unsigned char operator[](unsigned char key) const { return of[key]; }
+} HEADINGS;
+
+/* Board sizes whose move() is compiled for that size in particular, so
+ * the row length is a constant and the moves need no size lookups at all.
+ * Any other size uses move_sized<0, 0>(), which reads it from the Game. */
+struct FixedSize {
+        int y_dimension;
+        int x_dimension;
+        void (Game::*mover)();
+};
+
+/* fresh_seed()
+ * Purpose: Picks a seed for a new Game's food. It comes from the kernel's
+ *          random pool so that Games made together, as a Host makes them
+ *          for many players a second, each get food of their own; if that
+ *          fails, the time is mixed with a count of the Games made.
+ * Parameters: None
+ * Returns: uint64_t (the seed)
+ */
+static uint64_t fresh_seed()
+{
+        static atomic<uint64_t> made(0);
+        uint64_t seed;
+
+        if (getrandom(&seed, sizeof(seed), GRND_NONBLOCK) ==
+            (ssize_t)sizeof(seed)) {
+                return seed;
+        }
+        return (uint64_t)time(NULL) ^ ++made * 0x9E3779B97F4A7C15ULL;
+}
 
 /* Constructor
  * Purpose: Initialize members of the Game object
@@ -42,17 +69,29 @@ typedef enum Space {
  */
 Game::Game()
 {
-        srand(time(NULL));
+        rng.reseed(fresh_seed());
+        checkpoint = NULL;
+        scores = NULL;
+        run_codes = RUN_ERASE;
+        blank = false;
+        saved = 0;
         y_dimension = 0;
         x_dimension = 0;
-        y_head = 0;
-        x_head = 0;
+        stride = 0;
+        head = 0;
+        tail = 0;
+        empty_count = 0;
+        food_count = 0;
+        food_at_once = 1;
         snake_size = 1;
+        changes = 0;
         direction = UP;
         speed = 50;
         game_over = false; 
         won = false;
-        board = NULL;
+        cells = NULL;
+        mover = NULL;
+        level = NULL;
 }
 
 /* Parameterized Constructor
@@ -64,16 +103,14 @@ Game::Game()
  */
 Game::Game(int y_dimen, int x_dimen)
 {
-        srand(time(NULL));
+        rng.reseed(fresh_seed());
+        checkpoint = NULL;
+        scores = NULL;
+        run_codes = RUN_ERASE;
+        blank = false;
+        saved = 0;
         y_dimension = y_dimen;
         x_dimension = x_dimen;
-        y_head = y_dimension / 2;
-        x_head = x_dimension / 2;
-        snake_size = 1;
-        direction = UP;
-        speed = 50;
-        game_over = false;
-        won = false;
 
         if (y_dimension < 2 || x_dimension < 2) {
                 cerr << "Invalid Dimensions. Please choose dimensions "
@@ -81,18 +118,36 @@ Game::Game(int y_dimen, int x_dimen)
                 exit(EXIT_FAILURE);
         }
 
-        board = new int*[y_dimension];
-        for (int i = 0; i < y_dimension; i++) {
-                board[i] = new int[x_dimension];
-        }
-
-        for (int i = 0; i < y_dimension; i++) {
-                for (int j = 0; j < x_dimension; j++) {
-                        board[i][j] = EMPTY;
-                }
-        }
+        cells = NULL;
+        level = NULL;
+        food_at_once = 1;
+        changes = 0;
+        allocate_board();
+        reset();
+}
 
-        board[y_head][x_head] = HEAD;
+/* Level Constructor
+ * Purpose: Initialize members of the Game object to play on a level: its
+ *          board size, walls and obstacles, starting point and food rules.
+ * Parameters: map (Level to play; must outlive the Game)
+ * Returns: Nothing
+ */
+Game::Game(const Level &map)
+{
+        rng.reseed(fresh_seed());
+        checkpoint = NULL;
+        scores = NULL;
+        run_codes = RUN_ERASE;
+        blank = false;
+        saved = 0;
+        y_dimension = map.height();
+        x_dimension = map.width();
+        cells = NULL;
+        level = &map;
+        food_at_once = map.food_at_once();
+        changes = 0;
+        allocate_board();
+        reset();
 }
 
 /* Copy Constructor
@@ -103,25 +158,36 @@ Game::Game(int y_dimen, int x_dimen)
  */
 Game::Game(const Game &source)
 {
-        srand(time(NULL));
+        rng = source.rng;
+        checkpoint = NULL;
+        scores = NULL;
+        run_codes = RUN_ERASE;
+        blank = false;
+        saved = 0;
+        level = source.level;
         y_dimension = source.y_dimension;
         x_dimension = source.x_dimension;
-        y_head = source.y_head;
-        x_head = source.x_head;
+        head = source.head;
+        tail = source.tail;
+        empty_count = source.empty_count;
+        food_count = source.food_count;
+        food_at_once = source.food_at_once;
         snake_size = source.snake_size;
         direction = source.direction;
         speed = source.speed;
+        changes = source.changes;
         game_over = source.game_over;
         won = source.won;
 
-        board = new int*[y_dimension];
-        for (int i = 0; i < y_dimension; i++) {
-                board[i] = new int[x_dimension];
-
-                for (int j = 0; j < x_dimension; j++) {
-                        board[i][j] = source.board[i][j];
-                }
+        cells = NULL;
+        stride = 0;
+        mover = NULL;
+        if (source.cells != NULL) {
+                allocate_board();
+                copy_board(source);
         }
+        // After allocate_board(), which empties the index
+        foods = source.foods;
 }
 
 /* Assignment Overload "="
@@ -136,35 +202,38 @@ Game &Game::operator=(const Game &source)
                 return *this;
         }
 
-
-        if (this->board != NULL) {
-                for (int i = 0; i < this->y_dimension; i++) {
-                        if (this->board[i] != NULL) {
-                                delete[] this->board[i];
-                        }
-                }
-
-                delete[] this->board;
+        // Keep the board we have if it is already the right size
+        if (this->cells != NULL &&
+            (this->y_dimension != source.y_dimension ||
+             this->x_dimension != source.x_dimension ||
+             source.cells == NULL)) {
+                free_board();
         }
 
         this->y_dimension = source.y_dimension;
         this->x_dimension = source.x_dimension;
-        this->y_head = source.y_head;
-        this->x_head = source.x_head;
+        this->head = source.head;
+        this->rng = source.rng;
+        this->level = source.level;
+        this->tail = source.tail;
+        this->empty_count = source.empty_count;
+        this->food_count = source.food_count;
+        this->food_at_once = source.food_at_once;
         this->snake_size = source.snake_size;
         this->direction = source.direction;
         this->speed = source.speed;
+        this->changes = source.changes;
         this->game_over = source.game_over;
         this->won = source.won;
 
-        this->board = new int*[this->y_dimension];
-        for (int i = 0; i < this->y_dimension; i++) {
-                this->board[i] = new int[x_dimension];
-
-                for (int j = 0; j < this->x_dimension; j++) {
-                        this->board[i][j] = source.board[i][j];
+        if (source.cells != NULL) {
+                if (this->cells == NULL) {
+                        allocate_board();
                 }
+                copy_board(source);
         }
+        // After allocate_board(), which empties the index
+        this->foods = source.foods;
 
         return *this;
 }
@@ -176,62 +245,219 @@ Game &Game::operator=(const Game &source)
  */
 Game::~Game()
 {
-        if (board != NULL) {
+        free_board();
+}
+
+/* allocate_board()
+ * Purpose: Makes room for a board of the current dimensions, in one block
+ *          with a border of WALL cells all the way round, and picks the
+ *          version of move() for its size. The walls mean a move never
+ *          needs a bounds check: running into one is like running into the
+ *          Snake's own body.
+ * Parameters: None
+ * Returns: void
+ */
+void Game::allocate_board()
+{
+        static const FixedSize fixed_sizes[] = {
+                { 10, 40, &Game::move_sized<10, 40> },
+                { 20, 80, &Game::move_sized<20, 80> },
+                { 24, 80, &Game::move_sized<24, 80> }
+        };
+
+        stride = x_dimension + 2;
+        size_t size = (size_t)(y_dimension + 2) * stride;
+        cells = new unsigned char[size];
+        fill(cells, cells + size, (unsigned char)WALL);
+        foods.resize(y_dimension, x_dimension);
+
+        mover = &Game::move_sized<0, 0>;
+        for (const FixedSize &fixed : fixed_sizes) {
+                if (fixed.y_dimension == y_dimension &&
+                    fixed.x_dimension == x_dimension) {
+                        mover = fixed.mover;
+                }
+        }
+}
+
+/* free_board()
+ * Purpose: Frees the board, if there is one.
+ * Parameters: None
+ * Returns: void
+ */
+void Game::free_board()
+{
+        delete[] cells;
+        cells = NULL;
+}
+
+/* copy_board()
+ * Purpose: Copies every cell from another Game's board of the same size.
+ * Parameters: source (Game to copy the cells of)
+ * Returns: void
+ */
+void Game::copy_board(const Game &source)
+{
+        copy(source.cells,
+             source.cells + (size_t)(y_dimension + 2) * stride, cells);
+}
+
+/* clear_board()
+ * Purpose: Empties the board, or copies the level's layout onto it, and
+ *          puts the Snake's head on it.
+ * Parameters: None
+ * Returns: void
+ */
+void Game::clear_board()
+{
+        if (level != NULL) {
+                copy(level->cells(),
+                     level->cells() + (size_t)(y_dimension + 2) * stride,
+                     cells);
+        } else {
                 for (int i = 0; i < y_dimension; i++) {
-                        if (board[i] != NULL) {
-                                delete[] board[i];
-                        }
+                        fill(row(i), row(i) + x_dimension,
+                             (unsigned char)EMPTY);
                 }
+        }
+        cells[head] = HEAD;
+        foods.clear();
+}
 
-                delete[] board;
+/* reset()
+ * Purpose: Puts the game back how the constructor left it, for another
+ *          round on the same board. Nothing is allocated; the random
+ *          number stream simply carries on.
+ * Parameters: None
+ * Returns: void
+ */
+void Game::reset()
+{
+        if (level != NULL) {
+                head = index(level->spawn_y(), level->spawn_x());
+                empty_count = level->empty_count() - 1;
+                speed = level->start_speed();
+        } else {
+                head = index(y_dimension / 2, x_dimension / 2);
+                empty_count = y_dimension * x_dimension - 1;
+                speed = 50;
         }
-        end_game();
-        show_cursor();
-        cout << NORMAL;
-        place_cursor(16,0);
+        tail = head;
+        food_count = 0;
+        snake_size = 1;
+        direction = UP;
+        game_over = false;
+        won = false;
+        changes++;
+        clear_board();
 }
 
 /* run()
  * Purpose: Runs the Snake game, generating the first "food," retreiving user 
  *          input, and moving the Snake accordingly. Prints the board after
- *          every move and ends the game when the Snake hits the wall.
+ *          every move and ends the game when the Snake hits the wall. Each
+ *          time the player asks to play again, the same Game is reset and
+ *          played again.
  * Parameters: None
  * Returns: void
  */
 void Game::run()
 {
-        hide_cursor();
-        screen_clear();
-        bake_food();
-        print();
-        cout << "Enter \'w\', \'a\', \'s\', or \'d\' to start!" << endl;
+        bool again = true;
 
-        // Get initial input, do not start until a valid direction is provided
-        do {
-                direction = getachar();
-        } while (direction != UP && direction != DOWN && direction != LEFT &&
-                 direction != RIGHT);
-
-        move();
-        print();
-        while (!game_over) {
-                get_move();
-                move();
+        while (again) {
+                hide_cursor();
+                screen_clear();
+                blank = true;
+                start();
                 print();
+                cout << "Enter \'w\', \'a\', \'s\', or \'d\' to start!"
+                     << endl;
+
+                /* Get initial input, do not start until a valid direction is
+                 * provided */
+                while (!interrupted() && !begin(getachar())) {
+                }
+
+                while (!game_over && !interrupted()) {
+                        move();
+                        print();
+                        if (!game_over) {
+                                if (checkpoint != NULL) {
+                                        checkpoint->tick(*this);
+                                }
+                                get_move();
+                        }
+                }
+
+                if (checkpoint != NULL) {
+                        if (game_over) {
+                                checkpoint->discard();
+                        } else {
+                                checkpoint->save(*this);
+                        }
+                }
+
+                again = game_over && end_game();
+                if (again) {
+                        reset();
+                }
         }
+
+        show_cursor();
+        screen_reset();
+        place_cursor(16,0);
 }
 
-/* get_move()
- * Purpose: Gets a move from the user. If no move is provided, direction stays
- *          the same as the previous direction.
+/* start()
+ * Purpose: Readies a new game by generating the first "food" (as many as
+ *          are kept out at once), unless there is food already (as in a
+ *          resumed game). Only the first piece speeds the Snake up, so a
+ *          game with a lot of food out still starts slow. run() does this
+ *          itself; it is only needed when driving the game by hand with
+ *          begin(), steer() and step().
  * Parameters: None
  * Returns: void
  */
-void Game::get_move()
+void Game::start()
 {
-        char temp;
-        int wait = speed;
-        int opposite_direction;
+        if (food_count == 0 && bake_food()) {
+                speed_up();
+        }
+        while (food_count < food_at_once && empty_spaces()) {
+                bake_food();
+        }
+}
+
+/* begin()
+ * Purpose: Sets the Snake's first direction from a key press. Unlike
+ *          steer(), any of the four directions is allowed, except that a
+ *          resumed Snake that already has a body can't be turned around.
+ * Parameters: key (key pressed by the user)
+ * Returns: bool (true if key was a direction)
+ */
+bool Game::begin(char key)
+{
+        if (key != UP && key != DOWN && key != LEFT && key != RIGHT) {
+                return false;
+        }
+        if (tail != head && key != direction) {
+                return steer(key);
+        }
+
+        direction = key;
+        return true;
+}
+
+/* steer()
+ * Purpose: Turns the Snake from a key press. The user can't select the
+ *          direction the Snake is already going, or turn it around.
+ * Parameters: key (key pressed by the user)
+ * Returns: bool (true if the Snake turned)
+ */
+bool Game::steer(char key)
+{
+        int opposite_direction = '\0';
 
         /* Sets an opposite direction so that the user can't select to 
          * turn the Snake around */
@@ -252,241 +478,108 @@ void Game::get_move()
                         break;
         }
 
-        /* Keeps prompting for input until time runs out. This is the delay
-         * in between each of the Snake's moves. */
-        while (wait > 0) {
-                temp = getacharnow(0);
-                if (temp != '\0' && (temp == UP || temp == DOWN || 
-                                     temp == LEFT || temp == RIGHT)
-                                 && temp != direction
-                                 && temp != opposite_direction) {
-                        direction = temp;
-                        break;
-                }
-                usleep(10000);
-                wait -= 1;
+        if ((key == UP || key == DOWN || key == LEFT || key == RIGHT)
+            && key != direction && key != opposite_direction) {
+                direction = key;
+                return true;
         }
+        return false;
 }
 
-/* move()
- * Purpose: Moves the Snake's head an body in the direction it is supposed to
- *          go. Changes the direction of the body accordingly when it moves.
+/* step()
+ * Purpose: Moves the Snake one space in its current direction.
  * Parameters: None
  * Returns: void
  */
-void Game::move()
+void Game::step()
 {
-        switch (direction) {
-                case UP: 
-                        move_up();
-                        break;
-                case DOWN:
-                        move_down();
-                        break;
-                case LEFT:
-                        move_left();
-                        break;
-                case RIGHT:
-                        move_right();
-                        break;
-                default: 
-                        break;
+        if (!game_over) {
+                move();
         }
 }
 
-/* move_up()
- * Purpose: Moves the Snake's head up one space, and changes its body 
- *          positions and directions accordingly.
+/* get_move()
+ * Purpose: Gets a move from the user. If no move is provided, direction stays
+ *          the same as the previous direction.
  * Parameters: None
  * Returns: void
  */
-void Game::move_up()
+void Game::get_move()
 {
-        if (y_head - 1 < 0) {
-                // Case 1: Snake hits a wall
-                game_over = true;
-                return;
-        } else if (board[y_head - 1][x_head] == BODY_FROM_UP ||
-                   board[y_head - 1][x_head] == BODY_FROM_DOWN ||
-                   board[y_head - 1][x_head] == BODY_FROM_LEFT ||
-                   board[y_head - 1][x_head] == BODY_FROM_RIGHT) {
-                // Case 2: Snake hits its own body
-                game_over = true;
-                return;
-        } else if (board[y_head - 1][x_head] == FOOD) {
-                // Case 3: Snake hits food
-                carry_body(y_head, x_head, BODY_FROM_UP, true);
-                board[y_head--][x_head] = BODY_FROM_UP;
-                board[y_head][x_head] = HEAD;
-                bake_food();
-                snake_size++;
-        } else {
-                // Case 4: Snake doesn't hit anything
-                carry_body(y_head, x_head, BODY_FROM_UP, false);
-                board[y_head--][x_head] = BODY_FROM_UP;
-                board[y_head][x_head] = HEAD;
-        }
-}
+        int wait = speed;
 
-/* move_down()
- * Purpose: Moves the Snake's head down one space, and changes its body 
- *          positions and directions accordingly.
- * Parameters: None
- * Returns: void
- */
-void Game::move_down()
-{
-        if (y_head + 1 >= y_dimension) {
-                // Case 1: Snake hits a wall
-                game_over = true;
-                return;
-        } else if (board[y_head + 1][x_head] == BODY_FROM_UP ||
-                   board[y_head + 1][x_head] == BODY_FROM_DOWN ||
-                   board[y_head + 1][x_head] == BODY_FROM_LEFT ||
-                   board[y_head + 1][x_head] == BODY_FROM_RIGHT) {
-                // Case 2: Snake hits its own body
-                game_over = true;
-                return;
-        } else if (board[y_head + 1][x_head] == FOOD) {
-                // Case 3: Snake hits food
-                carry_body(y_head, x_head, BODY_FROM_DOWN, true);
-                board[y_head++][x_head] = BODY_FROM_DOWN;
-                board[y_head][x_head] = HEAD;
-                bake_food();
-                snake_size++;
-        } else {
-                // Case 4: Snake doesn't hit anything
-                carry_body(y_head, x_head, BODY_FROM_DOWN, false);
-                board[y_head++][x_head] = BODY_FROM_DOWN;
-                board[y_head][x_head] = HEAD;
+        /* Keeps prompting for input until time runs out. This is the delay
+         * in between each of the Snake's moves. */
+        while (wait > 0 && !interrupted()) {
+                if (steer(getacharnow(0))) {
+                        break;
+                }
+                usleep(10000);
+                wait -= 1;
         }
 }
 
-/* move_left()
- * Purpose: Moves the Snake's head left one space, and changes its body 
- *          positions and directions accordingly.
+/* move()
+ * Purpose: Moves the Snake's head an body in the direction it is supposed to
+ *          go. Changes the direction of the body accordingly when it moves.
  * Parameters: None
  * Returns: void
  */
-void Game::move_left()
+void Game::move()
 {
-        if (x_head - 1 < 0) {
-                // Case 1: Snake hits a wall
-                game_over = true;
-                return;
-        } else if (board[y_head][x_head - 1] == BODY_FROM_UP ||
-                   board[y_head][x_head - 1] == BODY_FROM_DOWN ||
-                   board[y_head][x_head - 1] == BODY_FROM_LEFT ||
-                   board[y_head][x_head - 1] == BODY_FROM_RIGHT) {
-                // Case 2: Snake hits its own body
-                game_over = true;
-                return;
-        } else if (board[y_head][x_head - 1] == FOOD) {
-                // Case 3: Snake hits food
-                carry_body(y_head, x_head, BODY_FROM_LEFT, true);
-                board[y_head][x_head--] = BODY_FROM_LEFT;
-                board[y_head][x_head] = HEAD;
-                bake_food();
-                snake_size++;
-        } else {
-                // Case 4: Snake doesn't hit anything
-                carry_body(y_head, x_head, BODY_FROM_LEFT, false);
-                board[y_head][x_head--] = BODY_FROM_LEFT;
-                board[y_head][x_head] = HEAD;
-        }
+        (this->*mover)();
+        changes++;
 }
 
-/* move_right()
- * Purpose: Moves the Snake's head right one space, and changes its body 
- *          positions and directions accordingly.
+/* move_sized()
+ * Purpose: move() for a board Y by X, or for any size when both are 0. The
+ *          head's old space becomes body pointing the way the head went, and
+ *          the body cell at the tail says which way the tail moves next, so
+ *          only those few cells change. A Snake that is just a head keeps
+ *          its old space, as the head's old space always becomes body.
  * Parameters: None
  * Returns: void
  */
-void Game::move_right()
+template <int Y, int X>
+void Game::move_sized()
 {
-        if (x_head + 1 >= x_dimension) {
-                // Case 1: Snake hits a wall
-                game_over = true;
-                return;
-        } else if (board[y_head][x_head + 1] == BODY_FROM_UP ||
-                   board[y_head][x_head + 1] == BODY_FROM_DOWN ||
-                   board[y_head][x_head + 1] == BODY_FROM_LEFT ||
-                   board[y_head][x_head + 1] == BODY_FROM_RIGHT) {
-                // Case 2: Snake hits its own body
-                game_over = true;
-                return;
-        } else if (board[y_head][x_head + 1] == FOOD) {
-                // Case 3: Snake hits food
-                carry_body(y_head, x_head, BODY_FROM_RIGHT, true);
-                board[y_head][x_head++] = BODY_FROM_RIGHT;
-                board[y_head][x_head] = HEAD;
-                bake_food();
-                snake_size++;
-        } else {
-                // Case 4: Snake doesn't hit anything
-                carry_body(y_head, x_head, BODY_FROM_RIGHT, false);
-                board[y_head][x_head++] = BODY_FROM_RIGHT;
-                board[y_head][x_head] = HEAD;
-        }
-}
+        const int width = X ? X + 2 : stride;
+        // Step to the neighbour a body cell points at, indexed by Space
+        const int offsets[] = { 0, -width, 1, width, -1 };
 
-/* carry_body()
- * Purpose: Recursive function to iterate through the body of the Snake, 
- *          each body part's direction accordingly and moving on to the next
- *          body part.
- * Parameters: y_position (the y coordinate of the body part being changed), 
- *             x_position (the x coordinate of the body part being changed), 
- *             new_direction (indicated direction that the current body part
- *             should now have), food (true if the head ate a food during the
- *             current move)
- * Returns: void
- */
-void Game::carry_body(int y_position, int x_position, int new_direction, 
-                      bool food)
-{
-        if (y_position - 1 >= 0 && 
-            board[y_position - 1][x_position] == BODY_FROM_DOWN) {
-                /* Case 1: The next part of the body is above the current 
-                 * location */
-                board[y_position][x_position] = new_direction;
-                carry_body(y_position - 1, x_position, BODY_FROM_DOWN, food);
-                return;
-        } 
-
-        if (y_position + 1 < y_dimension && 
-            board[y_position + 1][x_position] == BODY_FROM_UP) {
-                /* Case 2: The next part of the body is below the current 
-                 * location */
-                board[y_position][x_position] = new_direction;
-                carry_body(y_position + 1, x_position, BODY_FROM_UP, food);
+        int heading = HEADINGS[(unsigned char)direction];
+        if (heading == HEAD) {
                 return;
         }
 
-        if (x_position - 1 >= 0 && 
-            board[y_position][x_position - 1] == BODY_FROM_RIGHT) {
-                /* Case 3: The next part of the body is left of the current 
-                 * location */
-                board[y_position][x_position] = new_direction;
-                carry_body(y_position, x_position - 1, BODY_FROM_RIGHT, food);
+        int next = head + offsets[heading];
+        int target = cells[next];
+        if (target != EMPTY && target != FOOD) {
+                // Snake hits a wall or its own body
+                game_over = true;
                 return;
         }
 
-        if (x_position + 1 < x_dimension && 
-            board[y_position][x_position + 1] == BODY_FROM_LEFT) {
-                /* Case 4: The next part of the body is right of the current 
-                 * location */
-                board[y_position][x_position] = new_direction;
-                carry_body(y_position, x_position + 1, BODY_FROM_LEFT, food);
-                return;
+        bool food = (target == FOOD);
+        cells[head] = heading;
+        if (!food && tail != head) {
+                int tail_cell = cells[tail];
+                cells[tail] = EMPTY;
+                empty_count++;
+                tail += offsets[tail_cell];
         }
+        cells[next] = HEAD;
+        head = next;
 
-        
         if (food) {
-                // Case 4: Last part of the body, Snake ate food
-                board[y_position][x_position] = new_direction;
+                food_count--;
+                foods.remove(next / width - 1, next % width - 1);
+                if (bake_food()) {
+                        speed_up();
+                }
+                snake_size++;
         } else {
-                // Case 5: Last part of the body, Snake didn't eat food
-                board[y_position][x_position] = EMPTY;
+                empty_count--;
         }
 }
 
@@ -497,54 +590,40 @@ void Game::carry_body(int y_position, int x_position, int new_direction,
  */
 void Game::print()
 {
-        screen_home();
-        for (int i = 0; i < x_dimension + 2; i++) {
-                cout << RED_TEXT << BOLD << '_';
-        }
-        cout << NORMAL << endl;
+        string out;
+        render(out);
+        cout << out << flush;
+}
 
-        for (int i = 0; i < y_dimension; i++) {
-                cout << RED_TEXT << BOLD << '|' << NORMAL;
-                for (int j = 0; j < x_dimension; j++) {
-                        switch (board[i][j]) {
-                                case EMPTY: 
-                                        cout << ' ';
-                                        break;
-                                case HEAD: 
-                                        cout << YELLOW_TEXT << 'O' << NORMAL;
-                                        break;
-                                case BODY_FROM_UP: 
-                                        cout << BLUE_TEXT << BOLD << '|' 
-                                             << NORMAL;
-                                        break;
-                                case BODY_FROM_RIGHT: 
-                                        cout << BLUE_TEXT << BOLD << '-' 
-                                             << NORMAL;
-                                        break;
-                                case BODY_FROM_DOWN: 
-                                        cout << BLUE_TEXT << BOLD << '|' 
-                                             << NORMAL;
-                                        break;
-                                case BODY_FROM_LEFT: 
-                                        cout << BLUE_TEXT << BOLD << '-' 
-                                             << NORMAL;
-                                        break;
-                                case FOOD: 
-                                        cout << GREEN_BACKGROUND << BOLD 
-                                             <<'.' << NORMAL;
-                                        break;
-                                default:
-                                        break;
-                        }
-                }
-                cout << RED_TEXT << BOLD << '|' << NORMAL << endl;
-        }
+/* render()
+ * Purpose: Draws the board into a buffer instead of straight to the
+ *          terminal, so it can be sent somewhere other than cout. Runs of
+ *          spaces are erased and stepped over rather than sent, or just
+ *          stepped over if the screen has been cleared since the last
+ *          drawing, whenever that is shorter; see set_run_codes().
+ * Parameters: out (buffer to append the drawing to)
+ * Returns: void
+ */
+void Game::render(string &out)
+{
+        int codes = run_codes | (blank ? RUN_SKIP : 0);
+        blank = false;
+
+        out += "\033[H";
+        saved += encode_border('_', x_dimension + 2, out, codes);
+        out += "\r\n";
 
-        for (int i = 0; i < x_dimension + 2; i++) {
-                cout << RED_TEXT << BOLD << '-';
+        for (int i = 0; i < y_dimension; i++) {
+                encode_border('|', 1, out);
+                saved += encode_row(row(i), x_dimension, out, codes);
+                encode_border('|', 1, out);
+                out += "\r\n";
         }
-        cout << NORMAL << endl << "Size: " << snake_size << endl << endl;
 
+        saved += encode_border('-', x_dimension + 2, out, codes);
+        out += "\r\nSize: ";
+        out += to_string(snake_size);
+        out += "\r\n\r\n";
 }
 
 /* bake_food()
@@ -552,47 +631,74 @@ void Game::print()
  *          there is a space to put the food. If there are no spaces to put 
  *          the food and/or the board is full, it does nothing.
  * Parameters: None
- * Returns: void
+ * Returns: bool (true if food was put out)
  */
-void Game::bake_food()
+bool Game::bake_food()
 {
         int y_rand, x_rand;
         if (check_win() || !empty_spaces()) {
-                return;
+                return false;
         }
 
         /* Keep generating new coordinates on the board until an empty space
          * is found */
         do {
-                y_rand = rand() % y_dimension;
-                x_rand = rand() % x_dimension;
-        } while (board[y_rand][x_rand] != EMPTY);
-
-        board[y_rand][x_rand] = FOOD;
-        // Spped up the movement of the snake if it is still above 20
-        speed -= (speed > 20 ? 1 : 0);
+                y_rand = rng.below(y_dimension);
+                x_rand = rng.below(x_dimension);
+        } while (row(y_rand)[x_rand] != EMPTY);
+
+        row(y_rand)[x_rand] = FOOD;
+        foods.insert(y_rand, x_rand);
+        empty_count--;
+        food_count++;
+        return true;
 }
 
-/* check_win()
- * Purpose: Checks to see if the user has won the game
+/* speed_up()
+ * Purpose: Shortens the delay between moves once food has been put out in
+ *          place of food the Snake ate, down to the fastest speed.
  * Parameters: None
- * Returns: bool (true if the user has won the game)
+ * Returns: void
  */
-bool Game::check_win()
+void Game::speed_up()
 {
-        bool done = true;
+        // Spped up the movement of the snake if it is still above 20, or the
+        // level's fastest speed
+        int min_speed = (level != NULL) ? level->min_speed() : 20;
+        speed -= (speed > min_speed ? 1 : 0);
+}
 
+/* index_food()
+ * Purpose: Rebuilds the food index from the board, for when the cells have
+ *          been filled in from elsewhere (as when a game is resumed).
+ * Parameters: None
+ * Returns: void
+ */
+void Game::index_food()
+{
+        changes++;
+        foods.clear();
         for (int i = 0; i < y_dimension; i++) {
+                const unsigned char *cells_in = row(i);
                 for (int j = 0; j < x_dimension; j++) {
-                        if (board[i][j] == EMPTY || board[i][j] == FOOD) {
-                                done = false;
+                        if (cells_in[j] == FOOD) {
+                                foods.insert(i, j);
                         }
                 }
         }
+}
 
-        if (done) {
-                game_over = done;
-                won = done;
+/* check_win()
+ * Purpose: Checks to see if the user has won the game, which happens once
+ *          there are no empty spaces or food left on the board.
+ * Parameters: None
+ * Returns: bool (true if the user has won the game)
+ */
+bool Game::check_win()
+{
+        if (empty_count == 0 && food_count == 0) {
+                game_over = true;
+                won = true;
         }
 
         return won;
@@ -605,26 +711,17 @@ bool Game::check_win()
  */
 bool Game::empty_spaces()
 {
-        bool empty = false;
-
-        for (int i = 0; i < y_dimension; i++) {
-                for (int j = 0; j < x_dimension; j++) {
-                        if (board[i][j] == EMPTY) {
-                                empty = true;
-                        }
-                }
-        }
-
-        return empty;
+        return empty_count > 0;
 }
 
 /* end_game()
- * Purpose: Prints message to user based on if they won or lost. Prompts user
- *          if they want to play again
+ * Purpose: Prints message to user based on if they won or lost, and if
+ *          there is a leaderboard, records the score and shows the best
+ *          ones. Prompts user if they want to play again
  * Parameters: None
- * Returns: void
+ * Returns: bool (true if the user wants to play again)
  */
-void Game::end_game()
+bool Game::end_game()
 {
         char response;
         if (won) {
@@ -633,42 +730,35 @@ void Game::end_game()
                 cout << "Game Over!" << endl;
         }
 
+        if (scores != NULL) {
+                scores->record(player, snake_size);
+                Score best;
+                if (scores->best(player, best)) {
+                        cout << "Your best: " << best.score << endl;
+                }
+                vector<Score> leaders = scores->top(5);
+                for (size_t i = 0; i < leaders.size(); i++) {
+                        cout << i + 1 << ". " << leaders[i].player << " "
+                             << leaders[i].score << endl;
+                }
+        }
+
         cout << "Would you like to play again? (Y/N) ";
         response = getachar();
         while (toupper(response) != 'Y' && toupper(response) != 'N') {
+                if (interrupted()) {
+                        return false;
+                }
                 cerr << "\nInvalid Reponse. Please answer with \'Y\' or "
                      << "\'N\' ";
                 response = getachar();
         }
 
-        if (toupper(response) == 'Y') {
-                Game new_game(y_dimension, x_dimension);
-                new_game.run();
-        }
-
         cout << endl;
+        return toupper(response) == 'Y';
 }
 
 #undef UP
 #undef LEFT
 #undef DOWN
 #undef RIGHT
-
-#undef NORMAL 
-#undef BOLD 
-
-#undef RED_TEXT 
-#undef GREEN_TEXT 
-#undef YELLOW_TEXT 
-#undef BLUE_TEXT 
-#undef MAGENTA_TEXT 
-#undef CYAN_TEXT 
-#undef WHITE_TEXT
-
-#undef RED_BACKGROUND 
-#undef GREEN_BACKGROUND 
-#undef YELLOW_BACKGROUND
-#undef BLUE_BACKGROUND 
-#undef MAGENTA_BACKGROUND
-#undef CYAN_BACKGROUND 
-#undef WHITE_BACKGROUND
@@ -1,43 +1,121 @@
 #ifndef GAME_H_
 #define GAME_H_ 
 
+#include <string>
+#include "FoodIndex.h"
+#include "Rng.h"
+
+class Checkpoint;
+class Level;
+class Scores;
+
 class Game
 {
+        friend class Checkpoint;
+
         private:
                 int y_dimension;
                 int x_dimension;
-                int y_head;
-                int x_head;
+                int stride;             // cells per row, walls included
+                int head;               // cell index of the head
+                int tail;               // cell index of the end of the body
+                int empty_count;
+                int food_count;
+                int food_at_once;
                 int snake_size;
                 int direction;
                 int speed;
-                int **board;
+                unsigned changes;       // moves and resets so far
+                int run_codes;          // RunCodes render() may use
+                bool blank;             // screen cleared since render()
+                unsigned long long saved;       // bytes run codes saved
+                unsigned char *cells;   // board inside a ring of WALL cells
+                void (Game::*mover)();  // move() for this board size
+                const Level *level;     // layout and rules, if not the usual
+                FoodIndex foods;
+                Rng rng;
+                Checkpoint *checkpoint;
+                Scores *scores;         // where to record the score, if set
+                std::string player;     // who to record it for
 
                 bool game_over;
                 bool won;
 
+                unsigned char *row(int y) const
+                {
+                        return cells + (y + 1) * stride + 1;
+                }
+                int index(int y, int x) const
+                {
+                        return (y + 1) * stride + x + 1;
+                }
+
+                void allocate_board();
+                void free_board();
+                void copy_board(const Game &source);
+                void clear_board();
                 void print();
                 void get_move();
                 void move();
-                void move_up();
-                void move_down();
-                void move_left();
-                void move_right();
-                void carry_body(int y_position, int x_dimension, 
-                                int new_direction, bool food);
-                void bake_food();
+                template <int Y, int X> void move_sized();
+                bool bake_food();
+                void speed_up();
+                void index_food();
                 bool check_win();
                 bool empty_spaces();
-                void end_game();
+                bool end_game();
 
         public:
                 Game();
                 Game(int y_dimen, int x_dimen);
+                Game(const Level &map);
                 Game(const Game &source);
                 Game &operator=(const Game &source);
                 ~Game();
 
                 void run();
+                void set_checkpoint(Checkpoint *saver) { checkpoint = saver; }
+                void set_scores(Scores *board, const std::string &name)
+                {
+                        scores = board;
+                        player = name;
+                }
+
+                // For driving the game without a terminal, e.g. from a Host
+                void start();
+                void reset();
+                bool begin(char key);
+                bool steer(char key);
+                void step();
+                void render(std::string &out);
+                void set_run_codes(int codes) { run_codes = codes; }
+                void screen_cleared() { blank = true; }
+                unsigned long long bytes_saved() const { return saved; }
+                bool over() const { return game_over; }
+                bool has_won() const { return won; }
+                int delay() const { return speed * 10; }
+                void seed(uint64_t value) { rng.reseed(value); }
+                void set_food_at_once(int count) { food_at_once = count; }
+
+                // For looking at the board without drawing it
+                int height() const { return y_dimension; }
+                int width() const { return x_dimension; }
+                int size() const { return snake_size; }
+                int heading() const { return direction; }
+                unsigned version() const { return changes; }
+                int head_y() const { return head / stride - 1; }
+                int head_x() const { return head % stride - 1; }
+                int tail_y() const { return tail / stride - 1; }
+                int tail_x() const { return tail % stride - 1; }
+                bool nearest_food(int y, int x, int &food_y,
+                                  int &food_x) const
+                {
+                        return foods.nearest(y, x, food_y, food_x);
+                }
+                const unsigned char *cells_in_row(int y) const
+                {
+                        return row(y);
+                }
 };
 
 
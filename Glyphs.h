@@ -0,0 +1,233 @@
+#ifndef GLYPHS_H_
+#define GLYPHS_H_
+
+#include <cstring>
+#include <string>
+#include "Space.h"
+#include "termfuncs.h"
+
+/* How each Space is drawn: the character, plus which of a handful of
+ * styles it is drawn in. The styles' escape sequences are worked out at
+ * compile time, so drawing a cell never formats anything, and a run of
+ * cells in the same style shares one escape sequence and one reset. */
+
+enum StyleName { PLAIN = 0, HEAD_STYLE, BODY_STYLE, FOOD_STYLE, WALL_STYLE };
+
+constexpr Sgr STYLES[] = {
+        Sgr(),                                          // PLAIN
+        sgr_fg(Color::yellow),                          // HEAD_STYLE
+        sgr_fg(Color::blue) + sgr_attr(Attr::bright),   // BODY_STYLE
+        sgr_bg(Color::green) + sgr_attr(Attr::bright),  // FOOD_STYLE
+        sgr_fg(Color::red) + sgr_attr(Attr::bright)     // WALL_STYLE
+};
+
+constexpr Sgr RESET = sgr_attr(Attr::reset);
+
+struct Glyph {
+        char symbol;
+        unsigned char style;
+};
+
+// Indexed by Space
+constexpr Glyph GLYPHS[] = {
+        { 'O', HEAD_STYLE },            // HEAD
+        { '|', BODY_STYLE },            // BODY_FROM_UP
+        { '-', BODY_STYLE },            // BODY_FROM_RIGHT
+        { '|', BODY_STYLE },            // BODY_FROM_DOWN
+        { '-', BODY_STYLE },            // BODY_FROM_LEFT
+        { ' ', PLAIN },                 // EMPTY
+        { '.', FOOD_STYLE },            // FOOD
+        { '#', WALL_STYLE }             // WALL
+};
+
+/* Ways a run of one character may be sent in fewer bytes, as flags for
+ * encode_row() and encode_border(). Each run is sent whichever allowed way
+ * is shortest, so short runs are still sent as they are. */
+enum RunCodes {
+        RUN_ERASE = 1,          // spaces: erase them (ECH), step over (CUF)
+        RUN_SKIP = 2,           // spaces: step over (CUF); screen is blank
+        RUN_REPEAT = 4          // any: send once, then repeat it (REP)
+};
+
+/* digits()
+ * Purpose: Counts the decimal digits in a number.
+ * Parameters: n (number to count; at least 0)
+ * Returns: int (how many digits)
+ */
+inline int digits(int n)
+{
+        int count = 1;
+        while (n >= 10) {
+                n /= 10;
+                count++;
+        }
+        return count;
+}
+
+/* append_csi()
+ * Purpose: Copies a control sequence with one number to p, like
+ *          "\033[12C".
+ * Parameters: p (where to write), n (its number), final (its last
+ *             character, which says what it does)
+ * Returns: char * (just past what was written)
+ */
+inline char *append_csi(char *p, int n, char final)
+{
+        *p++ = '\033';
+        *p++ = '[';
+        char *end = p + digits(n);
+        for (char *q = end; q != p; n /= 10) {
+                *--q = '0' + n % 10;
+        }
+        *end = final;
+        return end + 1;
+}
+
+/* append_run()
+ * Purpose: Copies a run of one character to p, the shortest way codes
+ *          allow. Never writes more than count bytes.
+ * Parameters: p (where to write), symbol (the character), count (how many
+ *             times), codes (RunCodes allowed)
+ * Returns: char * (just past what was written)
+ */
+inline char *append_run(char *p, char symbol, int count, int codes)
+{
+        // Costs in bytes of each way; a way not allowed costs count
+        int skip = count, erase = count, repeat = count;
+        if (symbol == ' ' && (codes & RUN_SKIP)) {
+                skip = 3 + digits(count);
+        }
+        if (symbol == ' ' && (codes & RUN_ERASE)) {
+                erase = 6 + 2 * digits(count);
+        }
+        if ((codes & RUN_REPEAT) && count > 1) {
+                repeat = 4 + digits(count - 1);
+        }
+
+        if (skip < count && skip <= erase && skip <= repeat) {
+                return append_csi(p, count, 'C');
+        }
+        if (erase < count && erase <= repeat) {
+                p = append_csi(p, count, 'X');
+                return append_csi(p, count, 'C');
+        }
+        if (repeat < count) {
+                *p++ = symbol;
+                return append_csi(p, count - 1, 'b');
+        }
+        memset(p, symbol, count);
+        return p + count;
+}
+
+/* append_style()
+ * Purpose: Copies a style's escape sequence to p.
+ * Parameters: p (where to write), style (StyleName to write)
+ * Returns: char * (just past what was written)
+ */
+inline char *append_style(char *p, int style)
+{
+        memcpy(p, STYLES[style].codes, STYLES[style].length);
+        return p + STYLES[style].length;
+}
+
+/* style_run_bytes()
+ * Purpose: Works out the most bytes encode_row() can write for a row: one
+ *          escape sequence and one reset per run of the same style, and a
+ *          byte per cell, since append_run() never writes more than that.
+ * Parameters: cells (first cell of the row), width (number of cells)
+ * Returns: size_t (the bound)
+ */
+template <typename Cell>
+inline size_t style_run_bytes(const Cell *cells, int width)
+{
+        size_t bytes = width;
+        for (int j = 0; j < width; j++) {
+                int style = GLYPHS[cells[j]].style;
+                if (j == 0 || style != GLYPHS[cells[j - 1]].style) {
+                        bytes += STYLES[style].length;
+                        bytes += style != PLAIN ? RESET.length : 0;
+                }
+        }
+        return bytes;
+}
+
+/* encode_row()
+ * Purpose: Draws a row of cells. Cells are grouped into runs of the same
+ *          style, and each run is written as one escape sequence, its
+ *          symbols, and one reset, all straight into the buffer. Within
+ *          that, runs of the same symbol are sent the shortest way codes
+ *          allow. The buffer is grown only by what the row can take (see
+ *          style_run_bytes()), not by the most any cell could.
+ * Parameters: cells (first cell of the row; any integer type holding a
+ *             Space), width (number of cells), out (buffer to append to),
+ *             codes (RunCodes allowed)
+ * Returns: size_t (bytes saved by the run codes)
+ */
+template <typename Cell>
+inline size_t encode_row(const Cell *cells, int width, std::string &out,
+                         int codes = 0)
+{
+        size_t start = out.size();
+        out.resize(start + style_run_bytes(cells, width));
+        char *p = &out[start];
+        size_t saved = 0;
+
+        int j = 0;
+        while (j < width) {
+                int style = GLYPHS[cells[j]].style;
+                p = append_style(p, style);
+                do {
+                        char symbol = GLYPHS[cells[j]].symbol;
+                        int count = 1;
+                        while (j + count < width &&
+                               GLYPHS[cells[j + count]].symbol == symbol &&
+                               GLYPHS[cells[j + count]].style == style) {
+                                count++;
+                        }
+                        char *run = p;
+                        p = codes ? append_run(p, symbol, count, codes)
+                                  : (char *)memset(p, symbol, count) + count;
+                        saved += count - (p - run);
+                        j += count;
+                } while (j < width && GLYPHS[cells[j]].style == style);
+                if (style != PLAIN) {
+                        memcpy(p, RESET.codes, RESET.length);
+                        p += RESET.length;
+                }
+        }
+
+        out.resize(p - out.data());
+        return saved;
+}
+
+/* encode_cell()
+ * Purpose: Draws a single cell.
+ * Parameters: cell (Space to draw), out (buffer to append to)
+ * Returns: void
+ */
+inline void encode_cell(int cell, std::string &out)
+{
+        int cell_value = cell;
+        encode_row(&cell_value, 1, out);
+}
+
+/* encode_border()
+ * Purpose: Draws a run of border characters in the wall style.
+ * Parameters: symbol (character to repeat), count (how many), out (buffer
+ *             to append to), codes (RunCodes allowed)
+ * Returns: size_t (bytes saved by the run codes)
+ */
+inline size_t encode_border(char symbol, int count, std::string &out,
+                            int codes = 0)
+{
+        screen_append(out, STYLES[WALL_STYLE]);
+        size_t start = out.size();
+        out.resize(start + count);
+        char *end = append_run(&out[start], symbol, count, codes);
+        size_t saved = count - (end - &out[start]);
+        out.resize(end - out.data());
+        screen_append(out, RESET);
+        return saved;
+}
+
+#endif
@@ -0,0 +1,289 @@
+#include <atomic>
+#include <climits>
+#include <cstring>
+#include <ctime>
+#include <fcntl.h>
+#include <linux/futex.h>
+#include <stdint.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include "Game.h"
+#include "Gym.h"
+#include "Space.h"
+#include "termfuncs.h"
+using namespace std;
+
+// Bump GYM_VERSION whenever GymHeader or the slot layout changes
+static const char GYM_MAGIC[8] = { 'S', 'N', 'A', 'K', 'E', 'G', 'Y', 'M' };
+static const uint32_t GYM_VERSION = 1;
+
+// One-hot planes per observation: head, body, food, wall
+static const int CHANNELS = 4;
+
+// Key for each action
+static const char ACTION_KEYS[] = { '\0', 'w', 'd', 's', 'a' };
+
+/* The offsets let a trainer find everything without knowing how the gym
+ * lays slots out; all of them are multiples of 64. requested, completed
+ * and stop are shared with the trainer, so they are only ever touched
+ * atomically. */
+struct GymHeader {
+        char magic[8];
+        uint32_t version;
+        uint32_t header_size;
+        int32_t envs;
+        int32_t slots;
+        int32_t y_dimension;
+        int32_t x_dimension;
+        int32_t channels;
+        uint32_t reserved;
+        uint64_t slots_offset;          // first slot, from start of file
+        uint64_t slot_size;
+        uint64_t actions_offset;        // uint8_t per game, in a slot
+        uint64_t rewards_offset;        // float per game, in a slot
+        uint64_t dones_offset;          // uint8_t per game, in a slot
+        uint64_t observations_offset;   // planes per game, in a slot
+        atomic<uint32_t> requested;     // last step with actions written
+        atomic<uint32_t> completed;     // steps with results written
+        atomic<uint32_t> stop;          // set by either side to finish
+};
+
+/* align()
+ * Purpose: Rounds a size up to a whole number of cache lines.
+ * Parameters: size (bytes)
+ * Returns: uint64_t (size rounded up to a multiple of 64)
+ */
+static uint64_t align(uint64_t size)
+{
+        return (size + 63) & ~(uint64_t)63;
+}
+
+/* wait_while()
+ * Purpose: Sleeps until a shared counter changes from a value, or for at
+ *          most a tenth of a second.
+ * Parameters: word (counter to watch), value (value to wait while it has)
+ * Returns: void
+ */
+static void wait_while(atomic<uint32_t> *word, uint32_t value)
+{
+        timespec timeout = { 0, 100 * 1000000 };
+        syscall(SYS_futex, (uint32_t *)word, FUTEX_WAIT, value, &timeout,
+                NULL, 0);
+}
+
+/* wake_all()
+ * Purpose: Wakes everything sleeping on a shared counter, in any process.
+ * Parameters: word (counter that changed)
+ * Returns: void
+ */
+static void wake_all(atomic<uint32_t> *word)
+{
+        syscall(SYS_futex, (uint32_t *)word, FUTEX_WAKE, INT_MAX, NULL, NULL,
+                0);
+}
+
+/* Parameterized Constructor
+ * Purpose: Creates a gym of env_count games with a ring of slot_count steps.
+ * Parameters: env_count (games played side by side), slot_count (steps
+ *             kept in the ring)
+ * Returns: Nothing
+ */
+Gym::Gym(int env_count, int slot_count)
+{
+        envs = env_count;
+        slots = slot_count;
+        map = NULL;
+        length = 0;
+        header = NULL;
+}
+
+/* Destructor
+ * Purpose: Tells the trainer the gym has finished and unmaps the file.
+ * Parameters: None
+ * Returns: Nothing
+ */
+Gym::~Gym()
+{
+        if (header != NULL) {
+                header->stop.store(1);
+                wake_all(&header->completed);
+                munmap(map, length);
+        }
+}
+
+/* open()
+ * Purpose: Creates the shared file, starts every game and publishes step 0.
+ * Parameters: file (path of the shared file, e.g. under /dev/shm), y_dimen,
+ *             x_dimen (size of every board), seed (game i is seeded with
+ *             seed + i)
+ * Returns: bool (true on success)
+ */
+bool Gym::open(const string &file, int y_dimen, int x_dimen, unsigned seed)
+{
+        if (envs < 1 || slots < 2) {
+                return false;
+        }
+
+        games.assign(envs, Game(y_dimen, x_dimen));
+        for (int i = 0; i < envs; i++) {
+                games[i].seed(seed + i);
+                games[i].start();
+        }
+
+        uint64_t planes = (uint64_t)CHANNELS * y_dimen * x_dimen;
+        GymHeader layout;
+        memset((void *)&layout, 0, sizeof(layout));
+        layout.actions_offset = 0;
+        layout.rewards_offset = align(envs);
+        layout.dones_offset = layout.rewards_offset +
+                              align(envs * sizeof(float));
+        layout.observations_offset = layout.dones_offset + align(envs);
+        layout.slot_size = layout.observations_offset + align(envs * planes);
+        layout.slots_offset = align(sizeof(GymHeader));
+
+        int fd = ::open(file.c_str(), O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC,
+                        0644);
+        if (fd < 0) {
+                return false;
+        }
+        length = layout.slots_offset + layout.slot_size * slots;
+        if (ftruncate(fd, length) < 0) {
+                close(fd);
+                return false;
+        }
+        map = mmap(NULL, length, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        close(fd);
+        if (map == MAP_FAILED) {
+                map = NULL;
+                return false;
+        }
+
+        header = (GymHeader *)map;
+        memcpy(header->magic, GYM_MAGIC, 8);
+        header->version = GYM_VERSION;
+        header->header_size = sizeof(GymHeader);
+        header->envs = envs;
+        header->slots = slots;
+        header->y_dimension = y_dimen;
+        header->x_dimension = x_dimen;
+        header->channels = CHANNELS;
+        header->slots_offset = layout.slots_offset;
+        header->slot_size = layout.slot_size;
+        header->actions_offset = layout.actions_offset;
+        header->rewards_offset = layout.rewards_offset;
+        header->dones_offset = layout.dones_offset;
+        header->observations_offset = layout.observations_offset;
+
+        unsigned char *first = slot(0);
+        unsigned char *observations = first + header->observations_offset;
+        for (int i = 0; i < envs; i++) {
+                observe(i, observations + i * planes);
+        }
+        header->requested.store(0);
+        header->completed.store(1, memory_order_release);
+        wake_all(&header->completed);
+
+        return true;
+}
+
+/* run()
+ * Purpose: Plays a step whenever the trainer asks for one, until either
+ *          side sets stop or the gym is interrupted.
+ * Parameters: None
+ * Returns: void
+ */
+void Gym::run()
+{
+        while (!interrupted() && !header->stop.load()) {
+                uint32_t step = header->completed.load();
+                if (header->requested.load(memory_order_acquire) != step) {
+                        wait_while(&header->requested, step - 1);
+                        continue;
+                }
+
+                play(step);
+                header->completed.store(step + 1, memory_order_release);
+                wake_all(&header->completed);
+        }
+}
+
+/* slot()
+ * Purpose: Finds the slot a step's actions and results are kept in.
+ * Parameters: step (step number)
+ * Returns: unsigned char * (start of the slot)
+ */
+unsigned char *Gym::slot(unsigned step) const
+{
+        return (unsigned char *)map + header->slots_offset +
+               (step % slots) * header->slot_size;
+}
+
+/* observe()
+ * Purpose: Writes one game's board as one-hot planes: a byte per cell that
+ *          is 1 in the plane for what the cell holds and 0 in the others.
+ * Parameters: env (game to observe), planes (where its planes go)
+ * Returns: void
+ */
+void Gym::observe(int env, unsigned char *planes) const
+{
+        const Game &game = games[env];
+        int y_dimen = game.height();
+        int x_dimen = game.width();
+        size_t plane = (size_t)y_dimen * x_dimen;
+        unsigned char *head = planes;
+        unsigned char *body = planes + plane;
+        unsigned char *food = planes + 2 * plane;
+        unsigned char *wall = planes + 3 * plane;
+
+        for (int i = 0; i < y_dimen; i++) {
+                const unsigned char *cells = game.cells_in_row(i);
+                for (int j = 0; j < x_dimen; j++) {
+                        unsigned char cell = cells[j];
+                        *head++ = (cell == HEAD);
+                        *body++ = (cell >= BODY_FROM_UP &&
+                                   cell <= BODY_FROM_LEFT);
+                        *food++ = (cell == FOOD);
+                        *wall++ = (cell == WALL);
+                }
+        }
+}
+
+/* play()
+ * Purpose: Plays every game one move with the actions in a step's slot, and
+ *          writes the rewards, done flags and new boards over the same slot.
+ * Parameters: step (step to play)
+ * Returns: void
+ */
+void Gym::play(unsigned step)
+{
+        unsigned char *s = slot(step);
+        const unsigned char *actions = s + header->actions_offset;
+        float *rewards = (float *)(s + header->rewards_offset);
+        unsigned char *dones = s + header->dones_offset;
+        unsigned char *observations = s + header->observations_offset;
+        size_t planes = (size_t)CHANNELS * header->y_dimension *
+                        header->x_dimension;
+
+        for (int i = 0; i < envs; i++) {
+                Game &game = games[i];
+                if (actions[i] >= 1 && actions[i] <= 4) {
+                        game.begin(ACTION_KEYS[actions[i]]);
+                }
+
+                int size = game.size();
+                game.step();
+
+                if (game.over()) {
+                        rewards[i] = game.has_won() ? 1.0f : -1.0f;
+                        dones[i] = 1;
+                        game.reset();
+                        game.start();
+                } else {
+                        rewards[i] = (game.size() > size) ? 1.0f : 0.0f;
+                        dones[i] = 0;
+                }
+
+                observe(i, observations + i * planes);
+        }
+}
@@ -0,0 +1,52 @@
+#ifndef GYM_H_
+#define GYM_H_
+
+#include <string>
+#include <vector>
+
+class Game;
+struct GymHeader;
+
+/* Gym
+ * Runs a batch of headless Games for a training process on the same
+ * machine, talking through a shared memory file instead of a socket.
+ *
+ * The file is a header followed by a ring of slots. Each slot holds one
+ * action per game, and what came of it: a reward, a done flag, and an
+ * observation of four one-hot planes per game (head, body, food, wall), one
+ * byte per cell. Slot n % slots holds the results of step n, step 0 being
+ * the starting boards. The trainer reads step n, writes the actions for
+ * step n + 1 into the next slot and sets requested to n + 1; the gym then
+ * plays every game one move, fills that slot in place and sets completed to
+ * n + 2. Nothing is copied or serialized on either side, and the trainer
+ * can keep reading the last few steps while the gym writes the next.
+ *
+ * Actions are 0 (carry on), 1 (up), 2 (right), 3 (down) or 4 (left). The
+ * reward is 1 for eating, -1 for dying and 0 otherwise. A game that ends is
+ * started again at once, so with done set the observation is already the
+ * next game's first board.
+ */
+class Gym
+{
+        private:
+                int envs;
+                int slots;
+                void *map;
+                size_t length;
+                GymHeader *header;
+                std::vector<Game> games;
+
+                unsigned char *slot(unsigned step) const;
+                void observe(int env, unsigned char *planes) const;
+                void play(unsigned step);
+
+        public:
+                Gym(int env_count, int slot_count);
+                ~Gym();
+
+                bool open(const std::string &file, int y_dimen, int x_dimen,
+                          unsigned seed);
+                void run();
+};
+
+#endif
@@ -0,0 +1,560 @@
+#include <cerrno>
+#include <cstdlib>
+#include <ctime>
+#include <iostream>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include "Game.h"
+#include "Host.h"
+#include "Metrics.h"
+#include "Scores.h"
+#include "netfuncs.h"
+using namespace std;
+
+// Most bytes queued for one session before its frames are skipped
+static const size_t DEFAULT_BACKLOG = 64 * 1024;
+
+// Longest name a player may give; longer ones would be cut short by Scores
+static const size_t MAX_NAME = 31;
+static const int MAX_EVENTS = 256;
+
+/* now_ms()
+ * Purpose: Reads the monotonic clock.
+ * Parameters: None
+ * Returns: long long (milliseconds since an arbitrary fixed point)
+ */
+static long long now_ms()
+{
+        timespec ts;
+        clock_gettime(CLOCK_MONOTONIC, &ts);
+        return ts.tv_sec * 1000LL + ts.tv_nsec / 1000000;
+}
+
+/* Parameterized Constructor
+ * Purpose: Sets up the event loop for hosting games of the given size.
+ * Parameters: y_dimen (vertical size of every board), x_dimen (horizontal
+ *             size of every board)
+ * Returns: Nothing
+ */
+Host::Host(int y_dimen, int x_dimen)
+{
+        y_dimension = y_dimen;
+        x_dimension = x_dimen;
+        backlog_limit = DEFAULT_BACKLOG;
+        next_generation = 1;
+        scores = NULL;
+        stopping = false;
+
+        epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+        if (epoll_fd < 0) {
+                cerr << "Could not create event loop.\n";
+                exit(EXIT_FAILURE);
+        }
+}
+
+/* Destructor
+ * Purpose: Ends every session and closes all sockets.
+ * Parameters: None
+ * Returns: Nothing
+ */
+Host::~Host()
+{
+        {
+                lock_guard<mutex> guard(record_lock);
+                stopping = true;
+        }
+        record_ready.notify_one();
+        if (recorder.joinable()) {
+                recorder.join();
+        }
+
+        for (size_t i = 0; i < sessions.size(); i++) {
+                if (sessions[i] != NULL) {
+                        drop(sessions[i]);
+                }
+        }
+        for (size_t i = 0; i < listeners.size(); i++) {
+                close(listeners[i]);
+        }
+        close(epoll_fd);
+}
+
+/* listen_tcp()
+ * Purpose: Accepts players on a TCP port.
+ * Parameters: port (port number to listen on), address (address to bind
+ *             to)
+ * Returns: bool (true on success)
+ */
+bool Host::listen_tcp(int port, const string &address)
+{
+        return add_listener(::listen_tcp(port, address));
+}
+
+/* listen_unix()
+ * Purpose: Accepts players on a Unix domain socket.
+ * Parameters: path (file system path of the socket)
+ * Returns: bool (true on success)
+ */
+bool Host::listen_unix(const string &path)
+{
+        return add_listener(::listen_unix(path));
+}
+
+/* run()
+ * Purpose: Hosts games until the process is stopped. Sleeps until either a
+ *          socket is ready or the earliest session deadline comes up.
+ * Parameters: None
+ * Returns: void
+ */
+void Host::run()
+{
+        epoll_event events[MAX_EVENTS];
+
+        while (true) {
+                int timeout = -1;
+                if (!timers.empty()) {
+                        long long wait = timers.top().when - now_ms();
+                        timeout = wait > 0 ? (int)wait : 0;
+                }
+
+                int n = epoll_wait(epoll_fd, events, MAX_EVENTS, timeout);
+                if (n < 0 && errno != EINTR) {
+                        cerr << "epoll_wait failed.\n";
+                        return;
+                }
+
+                for (int i = 0; i < n; i++) {
+                        int fd = events[i].data.fd;
+
+                        bool listener = false;
+                        for (size_t j = 0; j < listeners.size(); j++) {
+                                listener = listener || listeners[j] == fd;
+                        }
+                        if (listener) {
+                                accept_sessions(fd);
+                                continue;
+                        }
+
+                        Session *s = sessions[fd];
+                        if (s == NULL) {
+                                // Dropped earlier in this batch
+                                continue;
+                        }
+                        if (events[i].events & (EPOLLERR | EPOLLHUP)) {
+                                drop(s);
+                                continue;
+                        }
+                        if (events[i].events & EPOLLOUT) {
+                                s->writable = true;
+                                flush(s);
+                        }
+                        if (sessions[fd] != NULL &&
+                            (events[i].events & EPOLLIN)) {
+                                read_input(s);
+                        }
+                }
+
+                run_timers();
+        }
+}
+
+/* add_listener()
+ * Purpose: Registers a listening socket with the event loop.
+ * Parameters: fd (listening socket, or -1 if opening it failed)
+ * Returns: bool (true if fd was valid and registered)
+ */
+bool Host::add_listener(int fd)
+{
+        if (fd < 0) {
+                return false;
+        }
+
+        epoll_event ev;
+        ev.events = EPOLLIN;
+        ev.data.fd = fd;
+        if (epoll_ctl(epoll_fd, EPOLL_CTL_ADD, fd, &ev) < 0) {
+                close(fd);
+                return false;
+        }
+        listeners.push_back(fd);
+        return true;
+}
+
+/* accept_sessions()
+ * Purpose: Accepts every pending connection on a listener, starting a new
+ *          game for each.
+ * Parameters: listener (listening socket that became readable)
+ * Returns: void
+ */
+void Host::accept_sessions(int listener)
+{
+        while (true) {
+                int fd = accept4(listener, NULL, NULL,
+                                 SOCK_NONBLOCK | SOCK_CLOEXEC);
+                if (fd < 0) {
+                        return;
+                }
+
+                /* Edge triggered, so EPOLLOUT is only reported when a full
+                 * socket buffer drains; until then the session is
+                 * writable. */
+                epoll_event ev;
+                ev.events = EPOLLIN | EPOLLOUT | EPOLLET;
+                ev.data.fd = fd;
+                if (epoll_ctl(epoll_fd, EPOLL_CTL_ADD, fd, &ev) < 0) {
+                        close(fd);
+                        continue;
+                }
+
+                if ((size_t)fd >= sessions.size()) {
+                        sessions.resize(fd + 1, NULL);
+                }
+                Session *s = new Session();
+                s->fd = fd;
+                s->writable = true;
+                s->generation = 0;
+                s->sent = 0;
+                s->game = NULL;
+                s->key_time = 0;
+                sessions[fd] = s;
+                Metrics::add(Metrics::SESSIONS_OPENED);
+                if (scores != NULL) {
+                        s->state = NAMING;
+                        send(s, "\033[H\033[2JYour name: ");
+                } else {
+                        new_game(s);
+                }
+        }
+}
+
+/* drop()
+ * Purpose: Ends a session and closes its connection. Any deadline it still
+ *          has in the timer heap is ignored when it comes up.
+ * Parameters: s (session to end)
+ * Returns: void
+ */
+void Host::drop(Session *s)
+{
+        sessions[s->fd] = NULL;
+        close(s->fd);
+        delete s->game;
+        delete s;
+        Metrics::add(Metrics::SESSIONS_CLOSED);
+}
+
+/* read_input()
+ * Purpose: Reads everything a session's player has typed and acts on each
+ *          key in turn.
+ * Parameters: s (session with input waiting)
+ * Returns: void
+ */
+void Host::read_input(Session *s)
+{
+        char buffer[64];
+        int fd = s->fd;
+
+        while (sessions[fd] == s) {
+                ssize_t n = read(fd, buffer, sizeof(buffer));
+                if (n == 0 || (n < 0 && errno != EAGAIN && errno != EINTR)) {
+                        drop(s);
+                        return;
+                }
+                if (n < 0) {
+                        if (errno == EINTR) {
+                                continue;
+                        }
+                        return;
+                }
+
+                s->key_time = Metrics::now_ns();
+                for (ssize_t i = 0; i < n && sessions[fd] == s; i++) {
+                        handle_key(s, buffer[i]);
+                }
+        }
+}
+
+/* handle_key()
+ * Purpose: Acts on one key from a player, following the same flow as
+ *          Game::run() and Game::end_game(): the first direction starts
+ *          the Snake, later ones turn it straight away, and once the game
+ *          is over 'Y' or 'N' decides whether to play again. Ctrl-C or
+ *          Ctrl-D ends the session at any point.
+ * Parameters: s (session the key belongs to), key (key pressed)
+ * Returns: void
+ */
+void Host::handle_key(Session *s, char key)
+{
+        if (key == '\003' || key == '\004') {
+                drop(s);
+                return;
+        }
+
+        switch (s->state) {
+                case NAMING:
+                        take_name(s, key);
+                        break;
+                case WAITING:
+                        if (s->game->begin(key)) {
+                                s->state = PLAYING;
+                                advance(s);
+                                Metrics::observe(Metrics::INPUT_LATENCY,
+                                                 Metrics::now_ns() -
+                                                 s->key_time);
+                        }
+                        break;
+                case PLAYING:
+                        if (s->game->steer(key)) {
+                                advance(s);
+                                Metrics::observe(Metrics::INPUT_LATENCY,
+                                                 Metrics::now_ns() -
+                                                 s->key_time);
+                        }
+                        break;
+                case ASKING:
+                        if (toupper(key) == 'Y') {
+                                s->game->reset();
+                                new_game(s);
+                        } else if (toupper(key) == 'N') {
+                                send(s, "\r\n\033[?25h");
+                                drop(s);
+                        } else {
+                                send(s, "\r\nInvalid Reponse. Please answer "
+                                        "with 'Y' or 'N' ");
+                        }
+                        break;
+        }
+}
+
+/* advance()
+ * Purpose: Moves a session's Snake, shows the result, and either sets the
+ *          deadline for its next move or asks whether to play again. A
+ *          move that eats is timed, since it places new food.
+ * Parameters: s (session to move)
+ * Returns: void
+ */
+void Host::advance(Session *s)
+{
+        int size = s->game->size();
+        uint64_t before = Metrics::now_ns();
+        s->game->step();
+        if (s->game->size() != size) {
+                Metrics::observe(Metrics::FOOD_PLACEMENT,
+                                 Metrics::now_ns() - before);
+        }
+        Metrics::add(Metrics::TICKS);
+        show_board(s);
+
+        if (!s->game->over()) {
+                schedule(s);
+                return;
+        }
+
+        Metrics::observe(Metrics::SNAKE_LENGTH, s->game->size());
+        if (scores != NULL) {
+                {
+                        lock_guard<mutex> guard(record_lock);
+                        unrecorded.push_back(make_pair(s->player,
+                                                       s->game->size()));
+                }
+                record_ready.notify_one();
+        }
+        s->state = ASKING;
+        s->generation = 0;
+        send(s, s->game->has_won() ? "Congratulations, you won!\r\n"
+                                   : "Game Over!\r\n");
+        send(s, "Would you like to play again? (Y/N) ");
+}
+
+/* schedule()
+ * Purpose: Sets a session's next move for one game delay from now,
+ *          replacing any deadline it already had.
+ * Parameters: s (session to schedule)
+ * Returns: void
+ */
+void Host::schedule(Session *s)
+{
+        Timer timer;
+        s->generation = next_generation++;
+        if (next_generation == 0) {
+                next_generation = 1;
+        }
+
+        timer.when = now_ms() + s->game->delay();
+        timer.fd = s->fd;
+        timer.generation = s->generation;
+        timers.push(timer);
+}
+
+/* run_timers()
+ * Purpose: Moves every session whose deadline has passed. Deadlines left
+ *          behind by a reschedule or a closed session are thrown away.
+ * Parameters: None
+ * Returns: void
+ */
+void Host::run_timers()
+{
+        long long now = now_ms();
+
+        while (!timers.empty() && timers.top().when <= now) {
+                Timer timer = timers.top();
+                timers.pop();
+
+                Session *s = sessions[timer.fd];
+                if (s != NULL && s->generation == timer.generation &&
+                    s->state == PLAYING) {
+                        advance(s);
+                }
+        }
+}
+
+/* show_board()
+ * Purpose: Sends a session the whole board. Each drawing replaces the last
+ *          completely, so if the player has fallen behind the drawing is
+ *          skipped and the next one catches them up.
+ * Parameters: s (session to draw for)
+ * Returns: void
+ */
+void Host::show_board(Session *s)
+{
+        if (s->out.size() - s->sent > backlog_limit) {
+                return;
+        }
+        size_t size = s->out.size();
+        unsigned long long saved = s->game->bytes_saved();
+        s->game->render(s->out);
+        Metrics::add(Metrics::FRAMES);
+        Metrics::add(Metrics::FRAME_BYTES, s->out.size() - size);
+        Metrics::add(Metrics::FRAME_BYTES_SAVED,
+                     s->game->bytes_saved() - saved);
+        flush(s);
+}
+
+/* send()
+ * Purpose: Sends text to a session's player.
+ * Parameters: s (session to send to), bytes (text to send)
+ * Returns: void
+ */
+void Host::send(Session *s, const string &bytes)
+{
+        s->out += bytes;
+        flush(s);
+}
+
+/* flush()
+ * Purpose: Writes as much of a session's backlog as the socket will take.
+ *          Errors are left for the event loop, which sees the socket hang
+ *          up and drops the session there.
+ * Parameters: s (session to write to)
+ * Returns: void
+ */
+void Host::flush(Session *s)
+{
+        while (s->writable && s->sent < s->out.size()) {
+                ssize_t n = ::send(s->fd, s->out.data() + s->sent,
+                                   s->out.size() - s->sent, MSG_NOSIGNAL);
+                if (n < 0) {
+                        if (errno == EINTR) {
+                                continue;
+                        }
+                        s->writable = false;
+                        return;
+                }
+                s->sent += n;
+        }
+
+        if (s->sent == s->out.size()) {
+                s->out.clear();
+                s->sent = 0;
+        }
+}
+
+/* new_game()
+ * Purpose: Starts a fresh game in a session and shows the starting board.
+ * Parameters: s (session to start a game in)
+ * Returns: void
+ */
+void Host::new_game(Session *s)
+{
+        if (s->game == NULL) {
+                s->game = new Game(y_dimension, x_dimension);
+        }
+        s->state = WAITING;
+        s->generation = 0;
+        s->game->start();
+
+        s->out += "\033[?25l\033[H\033[2J";
+        s->game->screen_cleared();
+        show_board(s);
+        send(s, "Enter 'w', 'a', 's', or 'd' to start!\r\n");
+}
+
+/* set_scores()
+ * Purpose: Records every finished game in a score file from now on, under
+ *          the name each player gives, and starts the thread that does the
+ *          recording.
+ * Parameters: board (score file, already open; must outlive the Host)
+ * Returns: void
+ */
+void Host::set_scores(Scores *board)
+{
+        scores = board;
+        if (scores != NULL && !recorder.joinable()) {
+                recorder = thread(&Host::record_loop, this);
+        }
+}
+
+/* take_name()
+ * Purpose: Acts on one key while a player is typing their name, echoing it
+ *          back since the player's terminal doesn't. Enter starts the
+ *          first game; a player who gives no name plays as "guest".
+ * Parameters: s (session the key belongs to), key (key pressed)
+ * Returns: void
+ */
+void Host::take_name(Session *s, char key)
+{
+        if (key == '\r' || key == '\n') {
+                if (s->player.empty()) {
+                        s->player = "guest";
+                }
+                new_game(s);
+        } else if (key == '\b' || key == '\177') {
+                if (!s->player.empty()) {
+                        s->player.erase(s->player.size() - 1);
+                        send(s, "\b \b");
+                }
+        } else if (key >= ' ' && key <= '~' &&
+                   s->player.size() < MAX_NAME) {
+                s->player += key;
+                send(s, string(1, key));
+        }
+}
+
+/* record_loop()
+ * Purpose: Body of the recording thread: waits for finished games and
+ *          records them, until the Host is destroyed.
+ * Parameters: None
+ * Returns: void
+ */
+void Host::record_loop()
+{
+        vector<pair<string, int> > batch;
+        unique_lock<mutex> guard(record_lock);
+
+        while (true) {
+                record_ready.wait(guard, [this] {
+                        return stopping || !unrecorded.empty();
+                });
+                if (unrecorded.empty()) {
+                        return;
+                }
+
+                batch.swap(unrecorded);
+                guard.unlock();
+                for (size_t i = 0; i < batch.size(); i++) {
+                        scores->record(batch[i].first, batch[i].second);
+                }
+                batch.clear();
+                guard.lock();
+        }
+}
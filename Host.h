@@ -0,0 +1,100 @@
+#ifndef HOST_H_
+#define HOST_H_
+
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <queue>
+#include <stdint.h>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+class Game;
+class Scores;
+
+/* Host
+ * Serves a separate single player Game to every connection, all from one
+ * thread. Each session is a small state machine (waiting for the first key,
+ * playing, asking to play again) driven by the shared epoll loop: input
+ * moves it along, and a playing session sets a deadline for its next move
+ * in a timer heap. Sessions that aren't playing have no deadline, so they
+ * cost nothing but their memory until their player types something.
+ *
+ * With a score file set, each player is first asked for a name, and every
+ * finished game is recorded under it. Recording locks the file and now and
+ * then waits for the disk, so it is handed to a thread of its own and the
+ * event loop never waits on it.
+ */
+class Host
+{
+        private:
+                enum State { NAMING, WAITING, PLAYING, ASKING };
+
+                struct Session {
+                        int fd;
+                        State state;
+                        bool writable;
+                        unsigned generation;
+                        size_t sent;
+                        uint64_t key_time;      // when input last came in
+                        std::string player;     // name scores go under
+                        std::string out;
+                        Game *game;
+                };
+
+                struct Timer {
+                        long long when;
+                        int fd;
+                        unsigned generation;
+
+                        bool operator>(const Timer &other) const
+                        {
+                                return when > other.when;
+                        }
+                };
+
+                int y_dimension;
+                int x_dimension;
+                size_t backlog_limit;
+                int epoll_fd;
+                std::vector<int> listeners;
+                std::vector<Session *> sessions;        // indexed by fd
+                std::priority_queue<Timer, std::vector<Timer>,
+                                    std::greater<Timer> > timers;
+                unsigned next_generation;
+                Scores *scores;
+
+                std::mutex record_lock;
+                std::condition_variable record_ready;
+                std::vector<std::pair<std::string, int> > unrecorded;
+                bool stopping;
+                std::thread recorder;
+
+                bool add_listener(int fd);
+                void accept_sessions(int listener);
+                void drop(Session *s);
+                void read_input(Session *s);
+                void handle_key(Session *s, char key);
+                void advance(Session *s);
+                void schedule(Session *s);
+                void run_timers();
+                void show_board(Session *s);
+                void send(Session *s, const std::string &bytes);
+                void flush(Session *s);
+                void new_game(Session *s);
+                void take_name(Session *s, char key);
+                void record_loop();
+
+        public:
+                Host(int y_dimen, int x_dimen);
+                ~Host();
+
+                bool listen_tcp(int port, const std::string &address);
+                bool listen_unix(const std::string &path);
+                void set_scores(Scores *board);
+                void run();
+};
+
+#endif
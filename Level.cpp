@@ -0,0 +1,331 @@
+#include <cstring>
+#include <fcntl.h>
+#include <fstream>
+#include <iostream>
+#include <stdint.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <vector>
+#include "Level.h"
+#include "Space.h"
+using namespace std;
+
+// Bump LEVEL_VERSION whenever LevelHeader or the cell encoding changes
+static const char LEVEL_MAGIC[8] = { 'S', 'N', 'A', 'K', 'E', 'L', 'V', 'L' };
+static const uint32_t LEVEL_VERSION = 1;
+
+// Largest side a level may have, so that a board with its walls still
+// fits the int cell indexes Game uses
+static const int32_t MAX_DIMENSION = 32767;
+
+/* Laid out like SaveHeader: naturally aligned, no padding, in the byte
+ * order of the machine that wrote it. */
+struct LevelHeader {
+        char magic[8];
+        uint32_t version;
+        uint32_t header_size;
+        int32_t y_dimension;
+        int32_t x_dimension;
+        int32_t spawn_y;
+        int32_t spawn_x;
+        int32_t food_at_once;
+        int32_t start_speed;
+        int32_t min_speed;
+        uint32_t reserved;
+};
+
+/* Constructor
+ * Purpose: Creates a Level with nothing loaded.
+ * Parameters: None
+ * Returns: Nothing
+ */
+Level::Level()
+{
+        map = NULL;
+        length = 0;
+        header = NULL;
+        empty = 0;
+}
+
+/* Destructor
+ * Purpose: Unmaps the level file.
+ * Parameters: None
+ * Returns: Nothing
+ */
+Level::~Level()
+{
+        unmap();
+}
+
+/* unmap()
+ * Purpose: Unmaps the level file, if one is mapped.
+ * Parameters: None
+ * Returns: void
+ */
+void Level::unmap()
+{
+        if (map != NULL) {
+                munmap(map, length);
+        }
+        map = NULL;
+        length = 0;
+        header = NULL;
+        empty = 0;
+}
+
+/* load()
+ * Purpose: Maps a level file and checks it: the header must match, every
+ *          cell must be a wall or empty, the edge must be all wall, and the
+ *          Snake must start on an empty space. Nothing is copied; games
+ *          read the cells from the mapping.
+ * Parameters: file (path of the level file)
+ * Returns: bool (true if the level can be played)
+ */
+bool Level::load(const string &file)
+{
+        unmap();
+
+        int fd = open(file.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd < 0) {
+                return false;
+        }
+
+        struct stat info;
+        if (fstat(fd, &info) < 0 ||
+            (size_t)info.st_size < sizeof(LevelHeader)) {
+                close(fd);
+                return false;
+        }
+
+        length = info.st_size;
+        map = mmap(NULL, length, PROT_READ, MAP_PRIVATE, fd, 0);
+        close(fd);
+        if (map == MAP_FAILED) {
+                map = NULL;
+                length = 0;
+                return false;
+        }
+        madvise(map, length, MADV_WILLNEED);
+
+        header = (const LevelHeader *)map;
+        size_t board_cells = 0;
+        bool valid = memcmp(header->magic, LEVEL_MAGIC, 8) == 0 &&
+                     header->version == LEVEL_VERSION &&
+                     header->header_size == sizeof(LevelHeader) &&
+                     header->y_dimension >= 2 && header->x_dimension >= 2 &&
+                     header->y_dimension <= MAX_DIMENSION &&
+                     header->x_dimension <= MAX_DIMENSION &&
+                     !__builtin_mul_overflow(
+                             (size_t)header->y_dimension + 2,
+                             (size_t)header->x_dimension + 2,
+                             &board_cells) &&
+                     header->spawn_y >= 0 && header->spawn_x >= 0 &&
+                     header->spawn_y < header->y_dimension &&
+                     header->spawn_x < header->x_dimension &&
+                     header->food_at_once >= 1 &&
+                     header->start_speed >= 1 && header->min_speed >= 1 &&
+                     length - sizeof(LevelHeader) == board_cells;
+        if (!valid) {
+                unmap();
+                return false;
+        }
+
+        const unsigned char *cell = cells();
+        int stride = header->x_dimension + 2;
+        int count = 0;
+        for (int i = 0; i < header->y_dimension + 2; i++) {
+                bool edge = (i == 0 || i == header->y_dimension + 1);
+                for (int j = 0; j < stride; j++, cell++) {
+                        if (*cell == EMPTY && !edge && j != 0 &&
+                            j != stride - 1) {
+                                count++;
+                        } else if (*cell != WALL) {
+                                unmap();
+                                return false;
+                        }
+                }
+        }
+
+        if (cells()[(header->spawn_y + 1) * stride + header->spawn_x + 1] !=
+            EMPTY) {
+                unmap();
+                return false;
+        }
+
+        empty = count;
+        return true;
+}
+
+/* build()
+ * Purpose: Makes a level file from a drawing of the board. The board is as
+ *          tall as the drawing and as wide as its longest line.
+ * Parameters: drawing (path of the text drawing), file (path of the level
+ *             file to write), food_at_once (food kept on the board),
+ *             start_speed (starting delay between moves, in hundredths of a
+ *             second), min_speed (shortest the delay gets as food is eaten)
+ * Returns: bool (true if the level file was written)
+ */
+bool Level::build(const string &drawing, const string &file,
+                  int food_at_once, int start_speed, int min_speed)
+{
+        ifstream in(drawing.c_str());
+        if (!in) {
+                cerr << "Cannot read " << drawing << "\n";
+                return false;
+        }
+
+        vector<string> lines;
+        string line;
+        size_t longest = 0;
+        while (getline(in, line)) {
+                if (!line.empty() && line[line.size() - 1] == '\r') {
+                        line.erase(line.size() - 1);
+                }
+                lines.push_back(line);
+                longest = max(longest, line.size());
+        }
+        while (!lines.empty() && lines.back().empty()) {
+                lines.pop_back();
+        }
+
+        LevelHeader header;
+        memset(&header, 0, sizeof(header));
+        memcpy(header.magic, LEVEL_MAGIC, 8);
+        header.version = LEVEL_VERSION;
+        header.header_size = sizeof(LevelHeader);
+        header.y_dimension = lines.size();
+        header.x_dimension = longest;
+        header.spawn_y = -1;
+        header.food_at_once = food_at_once;
+        header.start_speed = start_speed;
+        header.min_speed = min_speed;
+
+        if (lines.size() < 2 || longest < 2) {
+                cerr << "Invalid Dimensions. Please draw a board of size 2 "
+                     << "or greater.\n";
+                return false;
+        }
+        if (lines.size() > (size_t)MAX_DIMENSION ||
+            longest > (size_t)MAX_DIMENSION) {
+                cerr << "Invalid Dimensions. Please draw a board no bigger "
+                     << "than " << MAX_DIMENSION << " on a side.\n";
+                return false;
+        }
+        if (food_at_once < 1 || start_speed < 1 || min_speed < 1) {
+                cerr << "Food and speeds must be at least 1.\n";
+                return false;
+        }
+
+        int stride = header.x_dimension + 2;
+        vector<unsigned char> cells((size_t)(header.y_dimension + 2) * stride,
+                                    WALL);
+        for (int i = 0; i < header.y_dimension; i++) {
+                for (int j = 0; j < header.x_dimension; j++) {
+                        char c = (size_t)j < lines[i].size() ? lines[i][j]
+                                                             : ' ';
+                        if (c == '@') {
+                                header.spawn_y = i;
+                                header.spawn_x = j;
+                        }
+                        cells[(i + 1) * stride + j + 1] = (c == '#') ? WALL
+                                                                     : EMPTY;
+                }
+        }
+
+        if (header.spawn_y < 0) {
+                cerr << "No starting point. Please mark one with '@'.\n";
+                return false;
+        }
+
+        ofstream out(file.c_str(), ios::binary | ios::trunc);
+        out.write((const char *)&header, sizeof(header));
+        out.write((const char *)&cells[0], cells.size());
+        out.close();
+        if (!out) {
+                cerr << "Cannot write " << file << "\n";
+                return false;
+        }
+
+        return true;
+}
+
+/* height()
+ * Purpose: Gives the number of rows inside the walls.
+ * Parameters: None
+ * Returns: int (rows)
+ */
+int Level::height() const
+{
+        return header->y_dimension;
+}
+
+/* width()
+ * Purpose: Gives the number of columns inside the walls.
+ * Parameters: None
+ * Returns: int (columns)
+ */
+int Level::width() const
+{
+        return header->x_dimension;
+}
+
+/* spawn_y()
+ * Purpose: Gives the row the Snake starts on.
+ * Parameters: None
+ * Returns: int (row, from 0 inside the walls)
+ */
+int Level::spawn_y() const
+{
+        return header->spawn_y;
+}
+
+/* spawn_x()
+ * Purpose: Gives the column the Snake starts in.
+ * Parameters: None
+ * Returns: int (column, from 0 inside the walls)
+ */
+int Level::spawn_x() const
+{
+        return header->spawn_x;
+}
+
+/* food_at_once()
+ * Purpose: Gives how many food items are out at once.
+ * Parameters: None
+ * Returns: int (food items)
+ */
+int Level::food_at_once() const
+{
+        return header->food_at_once;
+}
+
+/* start_speed()
+ * Purpose: Gives the speed a game on the level starts at.
+ * Parameters: None
+ * Returns: int (tens of milliseconds between moves)
+ */
+int Level::start_speed() const
+{
+        return header->start_speed;
+}
+
+/* min_speed()
+ * Purpose: Gives the fastest a game on the level gets.
+ * Parameters: None
+ * Returns: int (fewest tens of milliseconds between moves)
+ */
+int Level::min_speed() const
+{
+        return header->min_speed;
+}
+
+/* cells()
+ * Purpose: Gives the level's cells, straight from the mapped file.
+ * Parameters: None
+ * Returns: const unsigned char * (first cell of the top wall row)
+ */
+const unsigned char *Level::cells() const
+{
+        return (const unsigned char *)map + sizeof(LevelHeader);
+}
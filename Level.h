@@ -0,0 +1,52 @@
+#ifndef LEVEL_H_
+#define LEVEL_H_
+
+#include <string>
+
+struct LevelHeader;
+
+/* Level
+ * A board layout and the rules to play it with. The file is a fixed header
+ * (size, where the Snake starts, how much food is out at once, starting
+ * and fastest speed) followed by one byte per cell, walls round the edge
+ * included, laid out exactly as Game keeps its board. So
+ * load() just maps the file and checks it, and every game played on the
+ * level starts by copying the mapped cells straight onto its board.
+ *
+ * build() makes a level file from a drawing: one line of text per row,
+ * with '#' for a wall or obstacle, '@' for where the Snake starts and
+ * anything else for an empty space.
+ */
+class Level
+{
+        private:
+                void *map;
+                size_t length;
+                const LevelHeader *header;
+                int empty;
+
+                void unmap();
+
+        public:
+                Level();
+                ~Level();
+                Level(const Level &) = delete;
+                Level &operator=(const Level &) = delete;
+
+                bool load(const std::string &file);
+                static bool build(const std::string &drawing,
+                                  const std::string &file, int food_at_once,
+                                  int start_speed, int min_speed);
+
+                int height() const;
+                int width() const;
+                int spawn_y() const;
+                int spawn_x() const;
+                int food_at_once() const;
+                int start_speed() const;
+                int min_speed() const;
+                int empty_count() const { return empty; }
+                const unsigned char *cells() const;
+};
+
+#endif
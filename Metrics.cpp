@@ -0,0 +1,350 @@
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstdio>
+#include <ctime>
+#include <mutex>
+#include <poll.h>
+#include <sys/socket.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+#include "Metrics.h"
+#include "netfuncs.h"
+using namespace std;
+
+// One thread's counters, on cache lines of their own
+struct alignas(64) Shard {
+        atomic<uint64_t> counters[Metrics::COUNTERS];
+        atomic<uint64_t> counts[Metrics::HISTOGRAMS][Metrics::BUCKETS + 1];
+        atomic<uint64_t> sums[Metrics::HISTOGRAMS];
+};
+
+struct CounterInfo {
+        const char *name;
+        const char *help;
+};
+
+struct HistogramInfo {
+        const char *name;
+        const char *help;
+        double scale;                   // recorded units per exported unit
+        uint64_t bounds[Metrics::BUCKETS];
+};
+
+static const CounterInfo COUNTER_INFO[Metrics::COUNTERS] = {
+        { "snake_ticks_total", "Moves made by every Snake." },
+        { "snake_frames_total", "Boards drawn." },
+        { "snake_frame_bytes_total", "Bytes in the boards drawn." },
+        { "snake_frame_bytes_saved_total",
+          "Bytes the boards drawn would have taken but for run codes." },
+        { "snake_sessions_opened_total", "Sessions started." },
+        { "snake_sessions_closed_total", "Sessions ended." }
+};
+
+static const HistogramInfo HISTOGRAM_INFO[Metrics::HISTOGRAMS] = {
+        { "snake_input_latency_seconds",
+          "Time from reading a key to sending the board it changed.", 1e9,
+          { 1000, 2500, 5000, 10000, 25000, 50000, 100000, 250000, 500000,
+            1000000, 2500000, 10000000 } },
+        { "snake_food_placement_seconds",
+          "Time taken by a move that ate, most of it placing new food.", 1e9,
+          { 250, 500, 1000, 2500, 5000, 10000, 25000, 50000, 100000, 250000,
+            500000, 1000000 } },
+        { "snake_length", "Length of the Snake when its game ended.", 1,
+          { 1, 2, 4, 8, 16, 32, 64, 128, 256, 512, 1024, 2048 } }
+};
+
+// Every thread's Shard, including threads that have ended
+static mutex shards_lock;
+static vector<Shard *> shards;
+static thread_local Shard *mine = NULL;
+
+/* own_shard()
+ * Purpose: Finds the calling thread's Shard, making one the first time.
+ * Parameters: None
+ * Returns: Shard & (the calling thread's)
+ */
+static Shard &own_shard()
+{
+        if (mine == NULL) {
+                Shard *shard = new Shard();
+                for (int i = 0; i < Metrics::COUNTERS; i++) {
+                        shard->counters[i] = 0;
+                }
+                for (int i = 0; i < Metrics::HISTOGRAMS; i++) {
+                        for (int j = 0; j <= Metrics::BUCKETS; j++) {
+                                shard->counts[i][j] = 0;
+                        }
+                        shard->sums[i] = 0;
+                }
+
+                lock_guard<mutex> guard(shards_lock);
+                shards.push_back(shard);
+                mine = shard;
+        }
+        return *mine;
+}
+
+/* bump()
+ * Purpose: Adds to a counter only the calling thread writes. Readers may
+ *          see the old or the new total, never anything else.
+ * Parameters: counter (counter to add to), amount (how much)
+ * Returns: void
+ */
+static inline void bump(atomic<uint64_t> &counter, uint64_t amount)
+{
+        counter.store(counter.load(memory_order_relaxed) + amount,
+                      memory_order_relaxed);
+}
+
+/* add()
+ * Purpose: Adds to one of the calling thread's counters.
+ * Parameters: counter (which one), amount (how much)
+ * Returns: void
+ */
+void Metrics::add(Counter counter, uint64_t amount)
+{
+        bump(own_shard().counters[counter], amount);
+}
+
+/* observe()
+ * Purpose: Records one value in one of the calling thread's histograms.
+ * Parameters: histogram (which one), value (in the histogram's units)
+ * Returns: void
+ */
+void Metrics::observe(Histogram histogram, uint64_t value)
+{
+        const uint64_t *bounds = HISTOGRAM_INFO[histogram].bounds;
+        int bucket = 0;
+        while (bucket < BUCKETS && value > bounds[bucket]) {
+                bucket++;
+        }
+
+        Shard &shard = own_shard();
+        bump(shard.counts[histogram][bucket], 1);
+        bump(shard.sums[histogram], value);
+}
+
+/* now_ns()
+ * Purpose: Reads the monotonic clock, for timing things to observe().
+ * Parameters: None
+ * Returns: uint64_t (nanoseconds since an arbitrary fixed point)
+ */
+uint64_t Metrics::now_ns()
+{
+        timespec ts;
+        clock_gettime(CLOCK_MONOTONIC, &ts);
+        return ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+/* append_line()
+ * Purpose: Appends one sample line of Prometheus text.
+ * Parameters: out (buffer to append to), name (metric name), labels (label
+ *             text without braces, or NULL), value (sample value)
+ * Returns: void
+ */
+static void append_line(string &out, const string &name, const char *labels,
+                        double value)
+{
+        char number[32];
+        snprintf(number, sizeof(number), "%.15g", value);
+
+        out += name;
+        if (labels != NULL) {
+                out += '{';
+                out += labels;
+                out += '}';
+        }
+        out += ' ';
+        out += number;
+        out += '\n';
+}
+
+/* append_header()
+ * Purpose: Appends the HELP and TYPE lines that come before a metric.
+ * Parameters: out (buffer to append to), name (metric name), help
+ *             (description), type (Prometheus type)
+ * Returns: void
+ */
+static void append_header(string &out, const string &name, const char *help,
+                          const char *type)
+{
+        out += "# HELP " + name + " " + help + "\n";
+        out += "# TYPE " + name + " " + type + "\n";
+}
+
+/* render()
+ * Purpose: Adds up every thread's counters and writes them out in
+ *          Prometheus text format. Threads carry on recording meanwhile,
+ *          so each total is as of some moment during the call.
+ * Parameters: out (buffer to append the text to)
+ * Returns: void
+ */
+void Metrics::render(string &out)
+{
+        uint64_t counters[COUNTERS] = {};
+        uint64_t counts[HISTOGRAMS][BUCKETS + 1] = {};
+        uint64_t sums[HISTOGRAMS] = {};
+        {
+                lock_guard<mutex> guard(shards_lock);
+                for (size_t s = 0; s < shards.size(); s++) {
+                        const Shard &shard = *shards[s];
+                        for (int i = 0; i < COUNTERS; i++) {
+                                counters[i] += shard.counters[i].load(
+                                        memory_order_relaxed);
+                        }
+                        for (int i = 0; i < HISTOGRAMS; i++) {
+                                for (int j = 0; j <= BUCKETS; j++) {
+                                        counts[i][j] += shard.counts[i][j]
+                                                .load(memory_order_relaxed);
+                                }
+                                sums[i] += shard.sums[i].load(
+                                        memory_order_relaxed);
+                        }
+                }
+        }
+
+        for (int i = 0; i < COUNTERS; i++) {
+                append_header(out, COUNTER_INFO[i].name, COUNTER_INFO[i].help,
+                              "counter");
+                append_line(out, COUNTER_INFO[i].name, NULL, counters[i]);
+        }
+
+        // Read apart, so a session can look closed before it looks opened
+        uint64_t opened = counters[SESSIONS_OPENED];
+        uint64_t closed = counters[SESSIONS_CLOSED];
+        append_header(out, "snake_active_sessions", "Sessions open now.",
+                      "gauge");
+        append_line(out, "snake_active_sessions", NULL,
+                    opened > closed ? opened - closed : 0);
+
+        for (int i = 0; i < HISTOGRAMS; i++) {
+                const HistogramInfo &info = HISTOGRAM_INFO[i];
+                string name = info.name;
+                append_header(out, name, info.help, "histogram");
+
+                uint64_t total = 0;
+                char label[48];
+                for (int j = 0; j < BUCKETS; j++) {
+                        total += counts[i][j];
+                        snprintf(label, sizeof(label), "le=\"%g\"",
+                                 info.bounds[j] / info.scale);
+                        append_line(out, name + "_bucket", label, total);
+                }
+                total += counts[i][BUCKETS];
+                append_line(out, name + "_bucket", "le=\"+Inf\"", total);
+                append_line(out, name + "_sum", NULL, sums[i] / info.scale);
+                append_line(out, name + "_count", NULL, total);
+        }
+}
+
+// Longest one scraper may take, in milliseconds, before it is dropped so
+// the next can be answered
+static const int ANSWER_MS = 1000;
+
+/* left_ms()
+ * Purpose: Works out how long is left until a deadline.
+ * Parameters: deadline (Metrics::now_ns() time)
+ * Returns: int (milliseconds left, 0 once it has passed)
+ */
+static int left_ms(uint64_t deadline)
+{
+        uint64_t now = Metrics::now_ns();
+        return now >= deadline ? 0 : (deadline - now + 999999) / 1000000;
+}
+
+/* answer()
+ * Purpose: Sends one scraper the current metrics. A scraper that sends an
+ *          HTTP request (such as curl --unix-socket) gets an HTTP reply;
+ *          one that sends nothing for a moment just gets the text. A
+ *          scraper that doesn't take the reply within ANSWER_MS is given
+ *          up on, so it can't hold up the ones after it.
+ * Parameters: fd (connected socket, nonblocking)
+ * Returns: void
+ */
+static void answer(int fd)
+{
+        uint64_t deadline = Metrics::now_ns() + ANSWER_MS * 1000000ULL;
+        char request[1024];
+        size_t got = 0;
+        pollfd ready = { fd, POLLIN, 0 };
+        while (got < sizeof(request) &&
+               poll(&ready, 1, min(100, left_ms(deadline))) > 0) {
+                ssize_t n = read(fd, request + got, sizeof(request) - got);
+                if (n < 0 && (errno == EAGAIN || errno == EINTR)) {
+                        continue;
+                }
+                if (n <= 0) {
+                        break;
+                }
+                got += n;
+                if (string(request, got).find("\r\n\r\n") != string::npos) {
+                        break;
+                }
+        }
+
+        string body;
+        Metrics::render(body);
+
+        string out;
+        if (got >= 4 && string(request, 4) == "GET ") {
+                out = "HTTP/1.0 200 OK\r\n"
+                      "Content-Type: text/plain; version=0.0.4\r\n"
+                      "Content-Length: " + to_string(body.size()) +
+                      "\r\n\r\n";
+        }
+        out += body;
+
+        size_t done = 0;
+        ready.events = POLLOUT;
+        while (done < out.size()) {
+                ssize_t n = send(fd, out.data() + done, out.size() - done,
+                                 MSG_NOSIGNAL);
+                if (n < 0 && (errno == EAGAIN || errno == EINTR)) {
+                        int wait = left_ms(deadline);
+                        if (wait == 0 || poll(&ready, 1, wait) <= 0) {
+                                return;
+                        }
+                        continue;
+                }
+                if (n <= 0) {
+                        return;
+                }
+                done += n;
+        }
+}
+
+/* serve()
+ * Purpose: Starts a thread that answers metrics scrapes on a Unix domain
+ *          socket, one at a time, for the rest of the process's life. The
+ *          thread only reads the counters, so the threads doing the work
+ *          never wait on it.
+ * Parameters: path (file system path of the socket)
+ * Returns: bool (true if the socket could be opened)
+ */
+bool Metrics::serve(const string &path)
+{
+        int listener = listen_unix(path);
+        if (listener < 0) {
+                return false;
+        }
+
+        thread([listener] {
+                pollfd ready = { listener, POLLIN, 0 };
+                while (true) {
+                        if (poll(&ready, 1, -1) < 0) {
+                                continue;
+                        }
+                        int fd = accept4(listener, NULL, NULL,
+                                         SOCK_NONBLOCK | SOCK_CLOEXEC);
+                        if (fd < 0) {
+                                continue;
+                        }
+                        answer(fd);
+                        close(fd);
+                }
+        }).detach();
+
+        return true;
+}
@@ -0,0 +1,52 @@
+#ifndef METRICS_H_
+#define METRICS_H_
+
+#include <stdint.h>
+#include <string>
+
+/* Metrics
+ * Counters and histograms for a running process, served in Prometheus text
+ * format on a Unix domain socket (see serve()).
+ *
+ * Every thread that records anything gets its own block of counters, which
+ * only it ever writes, so recording is a relaxed load and store on a cache
+ * line no other thread writes: no locks, no read-modify-write, and no
+ * sharing between threads. A scrape adds the blocks of all threads
+ * together. Blocks are kept after their thread ends, so totals never go
+ * backwards.
+ *
+ * Rates (ticks per second and so on) are left to Prometheus, which works
+ * them out from the totals; active sessions are sessions opened less
+ * sessions closed.
+ */
+class Metrics
+{
+        public:
+                enum Counter {
+                        TICKS,                  // moves made
+                        FRAMES,                 // boards drawn
+                        FRAME_BYTES,            // bytes in those boards
+                        FRAME_BYTES_SAVED,      // by run codes, see Glyphs.h
+                        SESSIONS_OPENED,
+                        SESSIONS_CLOSED,
+                        COUNTERS
+                };
+
+                enum Histogram {
+                        INPUT_LATENCY,          // key read to board sent, ns
+                        FOOD_PLACEMENT,         // move that ate, ns
+                        SNAKE_LENGTH,           // length when a game ends
+                        HISTOGRAMS
+                };
+
+                // Buckets in each histogram, not counting the last (+Inf)
+                static const int BUCKETS = 12;
+
+                static void add(Counter counter, uint64_t amount = 1);
+                static void observe(Histogram histogram, uint64_t value);
+                static uint64_t now_ns();
+                static void render(std::string &out);
+                static bool serve(const std::string &path);
+};
+
+#endif
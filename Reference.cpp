@@ -0,0 +1,317 @@
+#include "Reference.h"
+#include "Space.h"
+using namespace std;
+
+#define UP 'w'
+#define LEFT 'a'
+#define DOWN 's'
+#define RIGHT 'd'
+
+/* Parameterized Constructor
+ * Purpose: Sets up an empty board with the Snake's head in the middle.
+ * Parameters: y_dimen (vertical size of board), x_dimen (horizontal size
+ *             of board)
+ * Returns: Nothing
+ */
+Reference::Reference(int y_dimen, int x_dimen)
+        : board(y_dimen, vector<int>(x_dimen, EMPTY))
+{
+        y_dimension = y_dimen;
+        x_dimension = x_dimen;
+        y_head = y_dimension / 2;
+        x_head = x_dimension / 2;
+        food_at_once = 1;
+        snake_size = 1;
+        direction = UP;
+        speed = 50;
+        game_over = false;
+        won = false;
+        board[y_head][x_head] = HEAD;
+}
+
+/* start()
+ * Purpose: Puts out the first food, as many pieces as are kept out at
+ *          once. Only the first speeds the Snake up.
+ * Parameters: None
+ * Returns: void
+ */
+void Reference::start()
+{
+        if (bake_food()) {
+                speed_up();
+        }
+        while (food_count() < food_at_once && empty_spaces()) {
+                bake_food();
+        }
+}
+
+/* begin()
+ * Purpose: Sets the Snake's first direction; any direction will do.
+ * Parameters: key (key pressed)
+ * Returns: bool (true if key was a direction)
+ */
+bool Reference::begin(char key)
+{
+        if (key != UP && key != DOWN && key != LEFT && key != RIGHT) {
+                return false;
+        }
+        direction = key;
+        return true;
+}
+
+/* steer()
+ * Purpose: Turns the Snake, unless the key is not a direction, is the way
+ *          it is already going, or would turn it around.
+ * Parameters: key (key pressed)
+ * Returns: bool (true if the Snake turned)
+ */
+bool Reference::steer(char key)
+{
+        int opposite_direction = '\0';
+
+        switch (direction) {
+                case UP:
+                        opposite_direction = DOWN;
+                        break;
+                case DOWN:
+                        opposite_direction = UP;
+                        break;
+                case LEFT:
+                        opposite_direction = RIGHT;
+                        break;
+                case RIGHT:
+                        opposite_direction = LEFT;
+                        break;
+                default:
+                        break;
+        }
+
+        if (key != '\0' && (key == UP || key == DOWN || key == LEFT ||
+                            key == RIGHT)
+                        && key != direction
+                        && key != opposite_direction) {
+                direction = key;
+                return true;
+        }
+        return false;
+}
+
+/* step()
+ * Purpose: Moves the Snake once, unless the game is over.
+ * Parameters: None
+ * Returns: void
+ */
+void Reference::step()
+{
+        if (!game_over) {
+                move();
+        }
+}
+
+/* move()
+ * Purpose: Moves the Snake one space in its direction.
+ * Parameters: None
+ * Returns: void
+ */
+void Reference::move()
+{
+        switch (direction) {
+                case UP:
+                        move_to(y_head - 1, x_head, BODY_FROM_UP);
+                        break;
+                case DOWN:
+                        move_to(y_head + 1, x_head, BODY_FROM_DOWN);
+                        break;
+                case LEFT:
+                        move_to(y_head, x_head - 1, BODY_FROM_LEFT);
+                        break;
+                case RIGHT:
+                        move_to(y_head, x_head + 1, BODY_FROM_RIGHT);
+                        break;
+                default:
+                        break;
+        }
+}
+
+/* move_to()
+ * Purpose: Moves the head to a neighbouring space, as the original
+ *          move_up(), move_down(), move_left() and move_right() did.
+ * Parameters: y, x (space the head moves to), body (what the head's old
+ *             space becomes)
+ * Returns: void
+ */
+void Reference::move_to(int y, int x, int body)
+{
+        if (y < 0 || y >= y_dimension || x < 0 || x >= x_dimension) {
+                // Case 1: Snake hits a wall
+                game_over = true;
+        } else if (board[y][x] == BODY_FROM_UP ||
+                   board[y][x] == BODY_FROM_DOWN ||
+                   board[y][x] == BODY_FROM_LEFT ||
+                   board[y][x] == BODY_FROM_RIGHT) {
+                // Case 2: Snake hits its own body
+                game_over = true;
+        } else if (board[y][x] == FOOD) {
+                // Case 3: Snake hits food
+                carry_body(y_head, x_head, body, true);
+                board[y_head][x_head] = body;
+                y_head = y;
+                x_head = x;
+                board[y_head][x_head] = HEAD;
+                if (bake_food()) {
+                        speed_up();
+                }
+                snake_size++;
+        } else {
+                // Case 4: Snake doesn't hit anything
+                carry_body(y_head, x_head, body, false);
+                board[y_head][x_head] = body;
+                y_head = y;
+                x_head = x;
+                board[y_head][x_head] = HEAD;
+        }
+}
+
+/* carry_body()
+ * Purpose: Moves each part of the body into the space of the part before
+ *          it, finding the next part by which neighbour points back at
+ *          this one, and empties the last space unless the Snake ate.
+ * Parameters: y_position, x_position (part to move into), new_direction
+ *             (what that space becomes), food (true if the Snake ate)
+ * Returns: void
+ */
+void Reference::carry_body(int y_position, int x_position, int new_direction,
+                           bool food)
+{
+        if (y_position - 1 >= 0 &&
+            board[y_position - 1][x_position] == BODY_FROM_DOWN) {
+                board[y_position][x_position] = new_direction;
+                carry_body(y_position - 1, x_position, BODY_FROM_DOWN, food);
+                return;
+        }
+
+        if (y_position + 1 < y_dimension &&
+            board[y_position + 1][x_position] == BODY_FROM_UP) {
+                board[y_position][x_position] = new_direction;
+                carry_body(y_position + 1, x_position, BODY_FROM_UP, food);
+                return;
+        }
+
+        if (x_position - 1 >= 0 &&
+            board[y_position][x_position - 1] == BODY_FROM_RIGHT) {
+                board[y_position][x_position] = new_direction;
+                carry_body(y_position, x_position - 1, BODY_FROM_RIGHT, food);
+                return;
+        }
+
+        if (x_position + 1 < x_dimension &&
+            board[y_position][x_position + 1] == BODY_FROM_LEFT) {
+                board[y_position][x_position] = new_direction;
+                carry_body(y_position, x_position + 1, BODY_FROM_LEFT, food);
+                return;
+        }
+
+        if (food) {
+                // Last part of the body, Snake ate food
+                board[y_position][x_position] = new_direction;
+        } else {
+                // Last part of the body, Snake didn't eat food
+                board[y_position][x_position] = EMPTY;
+        }
+}
+
+/* bake_food()
+ * Purpose: Puts food on a random empty space, unless the game has been won
+ *          or there is no empty space.
+ * Parameters: None
+ * Returns: bool (true if food was put out)
+ */
+bool Reference::bake_food()
+{
+        int y_rand, x_rand;
+        if (check_win() || !empty_spaces()) {
+                return false;
+        }
+
+        do {
+                y_rand = rng.below(y_dimension);
+                x_rand = rng.below(x_dimension);
+        } while (board[y_rand][x_rand] != EMPTY);
+
+        board[y_rand][x_rand] = FOOD;
+        return true;
+}
+
+/* speed_up()
+ * Purpose: Shortens the delay between moves, down to the fastest speed.
+ * Parameters: None
+ * Returns: void
+ */
+void Reference::speed_up()
+{
+        speed -= (speed > 20 ? 1 : 0);
+}
+
+/* check_win()
+ * Purpose: Checks whether the game has been won: no empty space and no
+ *          food left anywhere on the board.
+ * Parameters: None
+ * Returns: bool (true if the game has been won)
+ */
+bool Reference::check_win()
+{
+        bool done = true;
+
+        for (int i = 0; i < y_dimension; i++) {
+                for (int j = 0; j < x_dimension; j++) {
+                        if (board[i][j] == EMPTY || board[i][j] == FOOD) {
+                                done = false;
+                        }
+                }
+        }
+
+        if (done) {
+                game_over = done;
+                won = done;
+        }
+
+        return won;
+}
+
+/* empty_spaces()
+ * Purpose: Checks whether any space on the board is empty.
+ * Parameters: None
+ * Returns: bool (true if there is an empty space)
+ */
+bool Reference::empty_spaces()
+{
+        for (int i = 0; i < y_dimension; i++) {
+                for (int j = 0; j < x_dimension; j++) {
+                        if (board[i][j] == EMPTY) {
+                                return true;
+                        }
+                }
+        }
+        return false;
+}
+
+/* food_count()
+ * Purpose: Counts the food on the board.
+ * Parameters: None
+ * Returns: int (pieces of food)
+ */
+int Reference::food_count()
+{
+        int count = 0;
+        for (int i = 0; i < y_dimension; i++) {
+                for (int j = 0; j < x_dimension; j++) {
+                        count += (board[i][j] == FOOD);
+                }
+        }
+        return count;
+}
+
+#undef UP
+#undef LEFT
+#undef DOWN
+#undef RIGHT
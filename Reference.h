@@ -0,0 +1,69 @@
+#ifndef REFERENCE_H_
+#define REFERENCE_H_
+
+#include <vector>
+#include "Rng.h"
+
+/* Reference
+ * The game as it was first written, kept frozen as the definition of how a
+ * Game must behave: a plain grid of Spaces with no walls around it, a body
+ * carried along by following the BODY_FROM_* cells back from the head, the
+ * whole board scanned for empty spaces and for a win, and food placed by
+ * drawing cells until an empty one comes up. The only changes from the
+ * original are the ones Game has made to what a game is rather than how it
+ * is played: food comes from an Rng so games can be replayed, and a number
+ * of pieces can be kept out at once. Only the first piece and those put
+ * out in place of eaten food speed the Snake up, as when there was just
+ * one.
+ *
+ * It is slow on purpose. Do not optimise it; snake_diff checks Game
+ * against it.
+ */
+class Reference
+{
+        private:
+                int y_dimension;
+                int x_dimension;
+                int y_head;
+                int x_head;
+                int food_at_once;
+                int snake_size;
+                int direction;
+                int speed;
+                std::vector<std::vector<int> > board;
+                Rng rng;
+
+                bool game_over;
+                bool won;
+
+                void move();
+                void move_to(int y, int x, int body);
+                void carry_body(int y_position, int x_position,
+                                int new_direction, bool food);
+                bool bake_food();
+                void speed_up();
+                bool check_win();
+                bool empty_spaces();
+                int food_count();
+
+        public:
+                Reference(int y_dimen, int x_dimen);
+
+                void seed(uint64_t value) { rng.reseed(value); }
+                void set_food_at_once(int count) { food_at_once = count; }
+                void start();
+                bool begin(char key);
+                bool steer(char key);
+                void step();
+
+                bool over() const { return game_over; }
+                bool has_won() const { return won; }
+                int delay() const { return speed * 10; }
+                int size() const { return snake_size; }
+                int heading() const { return direction; }
+                int head_y() const { return y_head; }
+                int head_x() const { return x_head; }
+                int cell(int y, int x) const { return board[y][x]; }
+};
+
+#endif
@@ -0,0 +1,42 @@
+#ifndef RNG_H_
+#define RNG_H_
+
+#include <stdint.h>
+
+/* Rng
+ * Purpose: Small deterministic random number generator (xorshift64*). Its
+ *          whole state is a single integer, so unlike rand() every board can
+ *          own one, and two boards seeded alike will play out identically.
+ */
+struct Rng {
+        uint64_t state;
+
+        explicit Rng(uint64_t seed = 1)
+        {
+                reseed(seed);
+        }
+
+        void reseed(uint64_t seed)
+        {
+                state = seed * 0x9E3779B97F4A7C15ULL + 1;
+                if (state == 0) {
+                        state = 1;
+                }
+        }
+
+        uint32_t next()
+        {
+                state ^= state >> 12;
+                state ^= state << 25;
+                state ^= state >> 27;
+                return (uint32_t)((state * 0x2545F4914F6CDD1DULL) >> 32);
+        }
+
+        // Returns a number in [0, n)
+        int below(int n)
+        {
+                return (int)(((uint64_t)next() * (uint64_t)n) >> 32);
+        }
+};
+
+#endif
@@ -0,0 +1,551 @@
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <ctime>
+#include <fcntl.h>
+#include <stdint.h>
+#include <sys/file.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "Scores.h"
+using namespace std;
+
+static const char INDEX_MAGIC[8] = { 'S', 'N', 'A', 'K', 'E', 'I', 'D', 'X' };
+static const uint32_t INDEX_VERSION = 1;
+static const int NAME_BYTES = 32;               // the last is always '\0'
+static const uint32_t TOP_CAPACITY = 1024;
+static const uint32_t FIRST_SLOTS = 1024;
+static const long long SYNC_AFTER_MS = 1000;
+static const int READ_BATCH = 256;              // log records read at once
+
+// One score in the log
+struct ScoreRecord {
+        char player[NAME_BYTES];
+        int64_t when;
+        int32_t score;
+        uint32_t check;         // of everything before it
+};
+
+// The index file: this, then TOP_CAPACITY entries best first, then a
+// hash table of each player's best, slots entries long
+struct IndexHeader {
+        char magic[8];
+        uint32_t version;
+        uint32_t top_count;
+        uint32_t slots;         // a power of two
+        uint32_t players;
+        uint64_t covered;       // bytes of the log taken in so far
+        char unused[32];
+};
+
+struct IndexEntry {
+        char player[NAME_BYTES];
+        int64_t when;
+        int32_t score;
+        uint32_t used;
+};
+
+/* fnv1a()
+ * Purpose: FNV-1a hash of some bytes.
+ * Parameters: bytes, count (what to hash)
+ * Returns: uint32_t (the hash)
+ */
+static uint32_t fnv1a(const char *bytes, size_t count)
+{
+        uint32_t h = 2166136261u;
+        for (size_t i = 0; i < count; i++) {
+                h = (h ^ (unsigned char)bytes[i]) * 16777619u;
+        }
+        return h;
+}
+
+/* checksum()
+ * Purpose: Works out what a log record's check should be.
+ * Parameters: record (record to check)
+ * Returns: uint32_t (the check)
+ */
+static uint32_t checksum(const ScoreRecord &record)
+{
+        return fnv1a((const char *)&record, offsetof(ScoreRecord, check));
+}
+
+/* index_size()
+ * Purpose: Works out how long the index file is with a given hash table.
+ * Parameters: slots (size of the hash table)
+ * Returns: size_t (bytes in the file)
+ */
+static size_t index_size(uint32_t slots)
+{
+        return sizeof(IndexHeader) +
+               (size_t)(TOP_CAPACITY + slots) * sizeof(IndexEntry);
+}
+
+/* now_ms()
+ * Purpose: Reads the monotonic clock.
+ * Parameters: None
+ * Returns: long long (milliseconds since an arbitrary fixed point)
+ */
+static long long now_ms()
+{
+        timespec ts;
+        clock_gettime(CLOCK_MONOTONIC, &ts);
+        return ts.tv_sec * 1000LL + ts.tv_nsec / 1000000;
+}
+
+/* to_score()
+ * Purpose: Turns an index entry into a Score.
+ * Parameters: entry (entry to convert)
+ * Returns: Score (the same score)
+ */
+static Score to_score(const IndexEntry &entry)
+{
+        Score score;
+        score.player = string(entry.player, strnlen(entry.player,
+                                                    NAME_BYTES));
+        score.score = entry.score;
+        score.when = entry.when;
+        return score;
+}
+
+/* Constructor
+ * Purpose: Creates a Scores with no files open.
+ * Parameters: None
+ * Returns: Nothing
+ */
+Scores::Scores()
+{
+        log_fd = -1;
+        index_fd = -1;
+        map = NULL;
+        length = 0;
+        batch = 1;
+        unsynced = 0;
+        oldest_unsynced = 0;
+}
+
+/* Destructor
+ * Purpose: Flushes any scores not yet on disk and closes the files.
+ * Parameters: None
+ * Returns: Nothing
+ */
+Scores::~Scores()
+{
+        close();
+}
+
+/* open()
+ * Purpose: Opens a score log and its index, making them if need be. An
+ *          index that is unreadable or from another version is rebuilt.
+ * Parameters: file (path of the log), batch_size (scores recorded between
+ *             flushes to disk)
+ * Returns: bool (true if both files could be opened)
+ */
+bool Scores::open(const string &file, int batch_size)
+{
+        close();
+        log_path = file;
+        index_path = file + ".idx";
+        batch = max(batch_size, 1);
+
+        log_fd = ::open(log_path.c_str(),
+                        O_RDWR | O_CREAT | O_APPEND | O_CLOEXEC, 0644);
+        index_fd = ::open(index_path.c_str(), O_RDWR | O_CREAT | O_CLOEXEC,
+                          0644);
+        if (log_fd < 0 || index_fd < 0) {
+                close();
+                return false;
+        }
+
+        flock(index_fd, LOCK_EX);
+        bool ready = remap();
+        if (ready && !valid_index()) {
+                ready = reset_index(FIRST_SLOTS);
+        }
+        flock(index_fd, LOCK_UN);
+
+        if (!ready) {
+                close();
+        }
+        return ready;
+}
+
+/* close()
+ * Purpose: Flushes any scores not yet on disk and closes the files.
+ * Parameters: None
+ * Returns: void
+ */
+void Scores::close()
+{
+        flush();
+        if (map != NULL) {
+                munmap(map, length);
+        }
+        if (log_fd >= 0) {
+                ::close(log_fd);
+        }
+        if (index_fd >= 0) {
+                ::close(index_fd);
+        }
+        map = NULL;
+        length = 0;
+        log_fd = -1;
+        index_fd = -1;
+}
+
+/* record()
+ * Purpose: Appends a score to the log. Any record left cut short by a
+ *          crash is cut off first, so records always line up. The log is
+ *          flushed to disk if the batch is full, or if the oldest score not
+ *          yet flushed was recorded over a second ago.
+ * Parameters: player (who scored; only the first 31 bytes are kept),
+ *             score (what they scored)
+ * Returns: bool (true if the score was appended)
+ */
+bool Scores::record(const string &player, int score)
+{
+        if (log_fd < 0) {
+                return false;
+        }
+
+        ScoreRecord entry;
+        memset(&entry, 0, sizeof(entry));
+        memcpy(entry.player, player.data(),
+               min(player.size(), (size_t)NAME_BYTES - 1));
+        entry.when = time(NULL);
+        entry.score = score;
+        entry.check = checksum(entry);
+
+        flock(log_fd, LOCK_EX);
+        struct stat info;
+        bool done = fstat(log_fd, &info) == 0;
+        off_t torn = done ? info.st_size % sizeof(ScoreRecord) : 0;
+        if (torn != 0) {
+                done = ftruncate(log_fd, info.st_size - torn) == 0;
+        }
+        if (done) {
+                ssize_t n = write(log_fd, &entry, sizeof(entry));
+                done = (n == (ssize_t)sizeof(entry));
+                if (n > 0 && !done) {
+                        ftruncate(log_fd, info.st_size - torn);
+                }
+        }
+        flock(log_fd, LOCK_UN);
+
+        if (done) {
+                if (unsynced++ == 0) {
+                        oldest_unsynced = now_ms();
+                }
+                if (unsynced >= batch ||
+                    now_ms() - oldest_unsynced >= SYNC_AFTER_MS) {
+                        flush();
+                }
+        }
+        return done;
+}
+
+/* flush()
+ * Purpose: Makes sure every score recorded so far is on disk.
+ * Parameters: None
+ * Returns: void
+ */
+void Scores::flush()
+{
+        if (log_fd >= 0 && unsynced > 0) {
+                fdatasync(log_fd);
+        }
+        unsynced = 0;
+}
+
+/* top()
+ * Purpose: Finds the best scores ever recorded, by anyone. Ties are in
+ *          the order they were recorded.
+ * Parameters: k (how many; at most 1024 are kept)
+ * Returns: vector<Score> (best first)
+ */
+vector<Score> Scores::top(int k)
+{
+        vector<Score> result;
+        if (index_fd < 0 || !catch_up()) {
+                return result;
+        }
+
+        int count = min(k, (int)header()->top_count);
+        IndexEntry *entries = top_entries();
+        for (int i = 0; i < count; i++) {
+                result.push_back(to_score(entries[i]));
+        }
+        flock(index_fd, LOCK_UN);
+        return result;
+}
+
+/* best()
+ * Purpose: Finds the best score a player has recorded.
+ * Parameters: player (who to look up), result (set to their best score)
+ * Returns: bool (false if they have never recorded one)
+ */
+bool Scores::best(const string &player, Score &result)
+{
+        if (index_fd < 0 || !catch_up()) {
+                return false;
+        }
+
+        char name[NAME_BYTES] = {};
+        memcpy(name, player.data(), min(player.size(),
+                                        (size_t)NAME_BYTES - 1));
+        IndexEntry *slot = find_slot(name);
+        bool found = slot->used;
+        if (found) {
+                result = to_score(*slot);
+        }
+        flock(index_fd, LOCK_UN);
+        return found;
+}
+
+/* top_entries()
+ * Purpose: Finds the best scores in the mapped index.
+ * Parameters: None
+ * Returns: IndexEntry * (the first of TOP_CAPACITY entries)
+ */
+IndexEntry *Scores::top_entries() const
+{
+        return (IndexEntry *)((char *)map + sizeof(IndexHeader));
+}
+
+/* slot_entries()
+ * Purpose: Finds the players' hash table in the mapped index.
+ * Parameters: None
+ * Returns: IndexEntry * (the first slot)
+ */
+IndexEntry *Scores::slot_entries() const
+{
+        return top_entries() + TOP_CAPACITY;
+}
+
+/* remap()
+ * Purpose: Maps the index file again if another process has changed its
+ *          length. Called with the index locked.
+ * Parameters: None
+ * Returns: bool (true if the whole file is mapped)
+ */
+bool Scores::remap()
+{
+        struct stat info;
+        if (fstat(index_fd, &info) < 0) {
+                return false;
+        }
+        if (map != NULL && (size_t)info.st_size == length) {
+                return true;
+        }
+
+        if (map != NULL) {
+                munmap(map, length);
+        }
+        map = NULL;
+        length = info.st_size;
+        if (length == 0) {
+                return true;
+        }
+
+        map = mmap(NULL, length, PROT_READ | PROT_WRITE, MAP_SHARED, index_fd,
+                   0);
+        if (map == MAP_FAILED) {
+                map = NULL;
+                length = 0;
+                return false;
+        }
+        return true;
+}
+
+/* log_end()
+ * Purpose: Finds where the last whole record in the log ends.
+ * Parameters: fd (the log), end (set to the offset)
+ * Returns: bool (true on success)
+ */
+static bool log_end(int fd, uint64_t &end)
+{
+        struct stat info;
+        if (fstat(fd, &info) < 0) {
+                return false;
+        }
+        end = info.st_size - info.st_size % sizeof(ScoreRecord);
+        return true;
+}
+
+/* catch_up()
+ * Purpose: Locks the index and makes sure it has taken in the whole log.
+ *          Usually it has, and a shared lock is all that is taken; if not,
+ *          the lock is made exclusive and the new records are read in. The
+ *          log's length is looked at again each time the lock changes, as
+ *          others may have added to it, and to the index, in between.
+ * Parameters: None
+ * Returns: bool (true if the index is locked and up to date; the caller
+ *          unlocks it)
+ */
+bool Scores::catch_up()
+{
+        uint64_t end;
+
+        flock(index_fd, LOCK_SH);
+        if (!log_end(log_fd, end)) {
+                flock(index_fd, LOCK_UN);
+                return false;
+        }
+        if (remap() && valid_index() && header()->covered == end) {
+                return true;
+        }
+
+        flock(index_fd, LOCK_EX);
+        bool ready = remap() && log_end(log_fd, end);
+        if (ready && !valid_index()) {
+                ready = reset_index(FIRST_SLOTS);
+        } else if (ready && header()->covered > end) {
+                // Even now the log is shorter than the index has taken in,
+                // so it was replaced; start again
+                ready = reset_index(header()->slots);
+        }
+        if (!ready) {
+                flock(index_fd, LOCK_UN);
+                return false;
+        }
+
+        ScoreRecord records[READ_BATCH];
+        uint64_t covered = header()->covered;
+        while (covered < end) {
+                size_t want = min((uint64_t)sizeof(records), end - covered);
+                ssize_t n = pread(log_fd, records, want, covered);
+                if (n < (ssize_t)sizeof(ScoreRecord)) {
+                        break;
+                }
+
+                int count = n / sizeof(ScoreRecord);
+                for (int i = 0; i < count; i++) {
+                        if (records[i].check != checksum(records[i])) {
+                                continue;
+                        }
+                        IndexEntry entry;
+                        memcpy(entry.player, records[i].player, NAME_BYTES);
+                        entry.player[NAME_BYTES - 1] = '\0';
+                        entry.when = records[i].when;
+                        entry.score = records[i].score;
+                        entry.used = 1;
+                        add_to_index(entry);
+                }
+                covered += count * sizeof(ScoreRecord);
+                header()->covered = covered;
+        }
+
+        return true;
+}
+
+/* valid_index()
+ * Purpose: Checks the mapped index is one this version can use, and is
+ *          all there. Called with the index locked.
+ * Parameters: None
+ * Returns: bool (true if it can be used)
+ */
+bool Scores::valid_index() const
+{
+        return length >= sizeof(IndexHeader) &&
+               memcmp(header()->magic, INDEX_MAGIC, 8) == 0 &&
+               header()->version == INDEX_VERSION &&
+               header()->slots >= FIRST_SLOTS &&
+               (header()->slots & (header()->slots - 1)) == 0 &&
+               length == index_size(header()->slots);
+}
+
+/* reset_index()
+ * Purpose: Empties the index, giving it a hash table of a given size, so
+ *          it is built again from the start of the log. Called with the
+ *          index locked exclusively.
+ * Parameters: slots (size of the hash table; a power of two)
+ * Returns: bool (true on success)
+ */
+bool Scores::reset_index(unsigned slots)
+{
+        if (ftruncate(index_fd, 0) < 0 ||
+            ftruncate(index_fd, index_size(slots)) < 0 || !remap()) {
+                return false;
+        }
+
+        IndexHeader *h = header();
+        memcpy(h->magic, INDEX_MAGIC, 8);
+        h->version = INDEX_VERSION;
+        h->top_count = 0;
+        h->slots = slots;
+        h->players = 0;
+        h->covered = 0;
+        return true;
+}
+
+/* add_to_index()
+ * Purpose: Takes one score into the index: into the best scores if it is
+ *          good enough, and as its player's best if it beats their last.
+ *          The hash table is doubled once it is half full. Called with the
+ *          index locked exclusively.
+ * Parameters: entry (score to take in)
+ * Returns: void
+ */
+void Scores::add_to_index(const IndexEntry &entry)
+{
+        IndexHeader *h = header();
+        IndexEntry *entries = top_entries();
+        uint32_t count = h->top_count;
+        if (count < TOP_CAPACITY || entry.score > entries[count - 1].score) {
+                IndexEntry *place = upper_bound(entries, entries + count,
+                        entry, [](const IndexEntry &a, const IndexEntry &b) {
+                                return a.score > b.score;
+                        });
+                IndexEntry *last = entries + min(count, TOP_CAPACITY - 1);
+                memmove(place + 1, place, (last - place) * sizeof(IndexEntry));
+                *place = entry;
+                h->top_count = min(count + 1, TOP_CAPACITY);
+        }
+
+        if ((h->players + 1) * 2 > h->slots) {
+                vector<IndexEntry> players;
+                for (uint32_t i = 0; i < h->slots; i++) {
+                        if (slot_entries()[i].used) {
+                                players.push_back(slot_entries()[i]);
+                        }
+                }
+
+                uint32_t slots = h->slots * 2;
+                if (ftruncate(index_fd, index_size(slots)) < 0 ||
+                    !remap()) {
+                        return;
+                }
+                h = header();
+                h->slots = slots;
+                memset(slot_entries(), 0, slots * sizeof(IndexEntry));
+                for (size_t i = 0; i < players.size(); i++) {
+                        *find_slot(players[i].player) = players[i];
+                }
+        }
+
+        IndexEntry *slot = find_slot(entry.player);
+        if (!slot->used) {
+                *slot = entry;
+                h->players++;
+        } else if (entry.score > slot->score) {
+                *slot = entry;
+        }
+}
+
+/* find_slot()
+ * Purpose: Finds a player's place in the hash table.
+ * Parameters: player (name, padded with '\0' to NAME_BYTES)
+ * Returns: IndexEntry * (their slot, or the empty one where it would go)
+ */
+IndexEntry *Scores::find_slot(const char *player) const
+{
+        uint32_t mask = header()->slots - 1;
+        uint32_t i = fnv1a(player, strnlen(player, NAME_BYTES)) & mask;
+        IndexEntry *slots = slot_entries();
+
+        while (slots[i].used &&
+               memcmp(slots[i].player, player, NAME_BYTES) != 0) {
+                i = (i + 1) & mask;
+        }
+        return &slots[i];
+}
@@ -0,0 +1,72 @@
+#ifndef SCORES_H_
+#define SCORES_H_
+
+#include <string>
+#include <vector>
+
+struct IndexHeader;
+struct IndexEntry;
+
+struct Score {
+        std::string player;
+        int score;
+        long long when;         // seconds since the epoch
+};
+
+/* Scores
+ * A leaderboard on disk that any number of processes can add to at once.
+ *
+ * Every score ever recorded is appended to a log file (the path given) as
+ * a fixed size record carrying a checksum, under an exclusive lock on the
+ * file. A record cut short by a crash is cut off by the next writer, and
+ * one that fails its checksum is never counted, so the log is always
+ * readable. To keep the disk from setting the pace, the log is only
+ * flushed to disk once a batch of scores has built up, when a score is
+ * recorded over a second after the oldest one not yet flushed, or when
+ * flush() is called.
+ *
+ * Queries are answered from an index file next to the log (path + ".idx"),
+ * mapped into memory and shared by every process: the best scores in
+ * order, and a hash table of each player's best. The index only ever says
+ * how much of the log it has taken in; whoever next looks at it after the
+ * log has grown reads just the new records into it. It can be deleted at
+ * any time and is rebuilt from the log.
+ */
+class Scores
+{
+        private:
+                std::string log_path;
+                std::string index_path;
+                int log_fd;
+                int index_fd;
+                void *map;
+                size_t length;
+                int batch;
+                int unsynced;
+                long long oldest_unsynced;
+
+                IndexHeader *header() const { return (IndexHeader *)map; }
+                IndexEntry *top_entries() const;
+                IndexEntry *slot_entries() const;
+                bool remap();
+                bool catch_up();
+                bool valid_index() const;
+                bool reset_index(unsigned slots);
+                void add_to_index(const IndexEntry &entry);
+                IndexEntry *find_slot(const char *player) const;
+
+        public:
+                Scores();
+                ~Scores();
+                Scores(const Scores &) = delete;
+                Scores &operator=(const Scores &) = delete;
+
+                bool open(const std::string &file, int batch_size = 32);
+                void close();
+                bool record(const std::string &player, int score);
+                void flush();
+                std::vector<Score> top(int k);
+                bool best(const std::string &player, Score &result);
+};
+
+#endif
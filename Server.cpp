@@ -0,0 +1,497 @@
+#include <cerrno>
+#include <cstdlib>
+#include <fcntl.h>
+#include <iostream>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <sys/timerfd.h>
+#include <sys/uio.h>
+#include <unistd.h>
+#include "Server.h"
+#include "netfuncs.h"
+using namespace std;
+
+#define CSI "\033["
+
+// Most bytes queued for one client before it is made to resync
+static const size_t DEFAULT_BACKLOG = 256 * 1024;
+static const int MAX_EVENTS = 256;
+// Most frames handed to the kernel in one gathered write
+static const int MAX_IOVECS = 64;
+
+/* Parameterized Constructor
+ * Purpose: Sets up the event loop and tick timer for serving an Arena.
+ * Parameters: game_arena (board to serve), tick_length (milliseconds
+ *             between moves)
+ * Returns: Nothing
+ */
+Server::Server(Arena &game_arena, int tick_length)
+        : arena(game_arena)
+{
+        tick_ms = tick_length;
+        backlog_limit = DEFAULT_BACKLOG;
+        client_count = 0;
+        spectator_count = 0;
+        last_players = -1;
+        last_spectators = -1;
+
+        epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+        timer_fd = timerfd_create(CLOCK_MONOTONIC,
+                                  TFD_NONBLOCK | TFD_CLOEXEC);
+        spare_fd = open("/dev/null", O_RDONLY | O_CLOEXEC);
+        if (epoll_fd < 0 || timer_fd < 0 || spare_fd < 0) {
+                cerr << "Could not create event loop.\n";
+                exit(EXIT_FAILURE);
+        }
+
+        epoll_event ev;
+        ev.events = EPOLLIN;
+        ev.data.fd = timer_fd;
+        epoll_ctl(epoll_fd, EPOLL_CTL_ADD, timer_fd, &ev);
+}
+
+/* Destructor
+ * Purpose: Disconnects every client and closes all sockets.
+ * Parameters: None
+ * Returns: Nothing
+ */
+Server::~Server()
+{
+        for (size_t i = 0; i < clients.size(); i++) {
+                if (clients[i] != NULL) {
+                        drop(clients[i]);
+                }
+        }
+        for (size_t i = 0; i < listeners.size(); i++) {
+                close(listeners[i]);
+        }
+        close(spare_fd);
+        close(timer_fd);
+        close(epoll_fd);
+}
+
+/* listen_tcp()
+ * Purpose: Accepts players on a TCP port.
+ * Parameters: port (port number to listen on), address (address to bind
+ *             to)
+ * Returns: bool (true on success)
+ */
+bool Server::listen_tcp(int port, const string &address)
+{
+        return add_listener(::listen_tcp(port, address), false);
+}
+
+/* listen_unix()
+ * Purpose: Accepts players on a Unix domain socket.
+ * Parameters: path (file system path of the socket)
+ * Returns: bool (true on success)
+ */
+bool Server::listen_unix(const string &path)
+{
+        return add_listener(::listen_unix(path), false);
+}
+
+/* watch_tcp()
+ * Purpose: Accepts spectators on a TCP port.
+ * Parameters: port (port number to listen on), address (address to bind
+ *             to)
+ * Returns: bool (true on success)
+ */
+bool Server::watch_tcp(int port, const string &address)
+{
+        return add_listener(::listen_tcp(port, address), true);
+}
+
+/* watch_unix()
+ * Purpose: Accepts spectators on a Unix domain socket.
+ * Parameters: path (file system path of the socket)
+ * Returns: bool (true on success)
+ */
+bool Server::watch_unix(const string &path)
+{
+        return add_listener(::listen_unix(path), true);
+}
+
+/* run()
+ * Purpose: Serves the game until the process is stopped. Ticks the Arena on
+ *          a timer, and otherwise only wakes for connections and input.
+ * Parameters: None
+ * Returns: void
+ */
+void Server::run()
+{
+        epoll_event events[MAX_EVENTS];
+        itimerspec spec;
+        spec.it_interval.tv_sec = tick_ms / 1000;
+        spec.it_interval.tv_nsec = (tick_ms % 1000) * 1000000L;
+        spec.it_value = spec.it_interval;
+        timerfd_settime(timer_fd, 0, &spec, NULL);
+
+        while (true) {
+                int n = epoll_wait(epoll_fd, events, MAX_EVENTS, -1);
+                if (n < 0 && errno != EINTR) {
+                        cerr << "epoll_wait failed.\n";
+                        return;
+                }
+
+                for (int i = 0; i < n; i++) {
+                        int fd = events[i].data.fd;
+                        if (fd == timer_fd) {
+                                uint64_t expirations;
+                                if (read(timer_fd, &expirations,
+                                         sizeof(expirations)) > 0) {
+                                        tick();
+                                }
+                                continue;
+                        }
+
+                        int listener = -1;
+                        for (size_t j = 0; j < listeners.size(); j++) {
+                                if (listeners[j] == fd) {
+                                        listener = j;
+                                }
+                        }
+                        if (listener >= 0) {
+                                accept_clients(fd, watch_only[listener]);
+                                continue;
+                        }
+
+                        Client *c = clients[fd];
+                        if (c == NULL) {
+                                // Dropped earlier in this batch
+                                continue;
+                        }
+                        if (events[i].events & (EPOLLERR | EPOLLHUP)) {
+                                drop(c);
+                                continue;
+                        }
+                        if (events[i].events & EPOLLOUT) {
+                                c->writable = true;
+                                flush(c);
+                        }
+                        if (clients[fd] != NULL &&
+                            (events[i].events & EPOLLIN)) {
+                                read_input(c);
+                        }
+                }
+        }
+}
+
+/* add_listener()
+ * Purpose: Registers a listening socket with the event loop.
+ * Parameters: fd (listening socket, or -1 if opening it failed),
+ *             spectators (true if clients from it only watch)
+ * Returns: bool (true if fd was valid and registered)
+ */
+bool Server::add_listener(int fd, bool spectators)
+{
+        if (fd < 0) {
+                return false;
+        }
+
+        epoll_event ev;
+        ev.events = EPOLLIN;
+        ev.data.fd = fd;
+        if (epoll_ctl(epoll_fd, EPOLL_CTL_ADD, fd, &ev) < 0) {
+                close(fd);
+                return false;
+        }
+        listeners.push_back(fd);
+        watch_only.push_back(spectators);
+        return true;
+}
+
+/* accept_clients()
+ * Purpose: Accepts every pending connection on a listener, giving each
+ *          player a snake of its own. Out of file descriptors, it turns
+ *          the connections away instead: the listener is level triggered,
+ *          so one left waiting would keep epoll_wait() returning at once.
+ * Parameters: listener (listening socket that became readable),
+ *             spectators (true if the new clients only watch)
+ * Returns: void
+ */
+void Server::accept_clients(int listener, bool spectators)
+{
+        while (true) {
+                int fd = accept4(listener, NULL, NULL,
+                                 SOCK_NONBLOCK | SOCK_CLOEXEC);
+                if (fd < 0 && (errno == EMFILE || errno == ENFILE)) {
+                        // Free the spare just long enough to take one
+                        close(spare_fd);
+                        fd = accept4(listener, NULL, NULL, SOCK_CLOEXEC);
+                        bool shed = fd >= 0;
+                        if (shed) {
+                                close(fd);
+                        }
+                        spare_fd = open("/dev/null", O_RDONLY | O_CLOEXEC);
+                        if (shed && spare_fd >= 0) {
+                                continue;
+                        }
+                        return;
+                }
+                if (fd < 0) {
+                        return;
+                }
+
+                /* Edge triggered, so EPOLLOUT is only reported when a full
+                 * socket buffer drains; until then the client is writable. */
+                epoll_event ev;
+                ev.events = EPOLLIN | EPOLLOUT | EPOLLET | EPOLLRDHUP;
+                ev.data.fd = fd;
+                if (epoll_ctl(epoll_fd, EPOLL_CTL_ADD, fd, &ev) < 0) {
+                        close(fd);
+                        continue;
+                }
+
+                if ((size_t)fd >= clients.size()) {
+                        clients.resize(fd + 1, NULL);
+                }
+                Client *c = new Client();
+                c->fd = fd;
+                c->player = spectators ? -1 : arena.add_player();
+                c->resync = true;
+                c->writable = true;
+                c->sent = 0;
+                c->backlog = 0;
+                clients[fd] = c;
+                client_count++;
+                spectator_count += spectators;
+                flush(c);
+        }
+}
+
+/* drop()
+ * Purpose: Disconnects a client and removes its snake from the board.
+ * Parameters: c (client to disconnect)
+ * Returns: void
+ */
+void Server::drop(Client *c)
+{
+        if (c->player >= 0) {
+                arena.remove_player(c->player);
+        } else {
+                spectator_count--;
+        }
+        clients[c->fd] = NULL;
+        close(c->fd);
+        client_count--;
+        delete c;
+}
+
+/* read_input()
+ * Purpose: Reads everything a client has sent, steering its snake with each
+ *          direction key. 'q' disconnects. Spectators can only quit.
+ * Parameters: c (client with input waiting)
+ * Returns: void
+ */
+void Server::read_input(Client *c)
+{
+        char buffer[256];
+
+        while (true) {
+                ssize_t n = read(c->fd, buffer, sizeof(buffer));
+                if (n == 0 || (n < 0 && errno != EAGAIN && errno != EINTR)) {
+                        drop(c);
+                        return;
+                }
+                if (n < 0) {
+                        if (errno == EINTR) {
+                                continue;
+                        }
+                        return;
+                }
+
+                for (ssize_t i = 0; i < n; i++) {
+                        if (buffer[i] == 'q') {
+                                drop(c);
+                                return;
+                        }
+                        if (c->player >= 0) {
+                                arena.steer(c->player, buffer[i]);
+                        }
+                }
+        }
+}
+
+/* flush()
+ * Purpose: Writes as many of a client's queued frames as the socket will
+ *          take, handing the shared buffers straight to the kernel. A
+ *          client waiting on a resync is sent the whole board once its
+ *          queue is empty.
+ * Parameters: c (client to write to)
+ * Returns: void
+ */
+void Server::flush(Client *c)
+{
+        if (c->resync && c->frames.empty()) {
+                c->frames.push_back(current_keyframe());
+                c->backlog = c->frames.back()->size();
+                c->sent = 0;
+                c->resync = false;
+        }
+
+        while (c->writable && !c->frames.empty()) {
+                iovec iov[MAX_IOVECS];
+                int count = 0;
+                for (size_t i = 0; i < c->frames.size() && count < MAX_IOVECS;
+                     i++) {
+                        size_t skip = (i == 0) ? c->sent : 0;
+                        iov[count].iov_base =
+                                (void *)(c->frames[i]->data() + skip);
+                        iov[count].iov_len = c->frames[i]->size() - skip;
+                        count++;
+                }
+
+                msghdr msg = msghdr();
+                msg.msg_iov = iov;
+                msg.msg_iovlen = count;
+                ssize_t n = sendmsg(c->fd, &msg, MSG_NOSIGNAL);
+                if (n < 0) {
+                        if (errno == EINTR) {
+                                continue;
+                        }
+                        if (errno == EAGAIN || errno == EWOULDBLOCK) {
+                                c->writable = false;
+                                return;
+                        }
+                        drop(c);
+                        return;
+                }
+
+                // Release every frame that went out in full
+                c->backlog -= n;
+                size_t written = n + c->sent;
+                while (!c->frames.empty() &&
+                       written >= c->frames.front()->size()) {
+                        written -= c->frames.front()->size();
+                        c->frames.pop_front();
+                }
+                c->sent = written;
+        }
+}
+
+/* queue()
+ * Purpose: Adds a delta to a client's queue, or stops sending it deltas
+ *          if its backlog is already over the limit. Skipped deltas are
+ *          made up for by a full board once the backlog drains.
+ * Parameters: c (client to send to), frame (delta to send)
+ * Returns: void
+ */
+void Server::queue(Client *c, const Frame &frame)
+{
+        if (c->resync) {
+                return;
+        }
+        if (c->backlog + frame->size() > backlog_limit) {
+                c->resync = true;
+                return;
+        }
+        c->frames.push_back(frame);
+        c->backlog += frame->size();
+}
+
+/* tick()
+ * Purpose: Moves every snake, then sends the changed cells to each client.
+ *          The delta is encoded once and shared by every client.
+ * Parameters: None
+ * Returns: void
+ */
+void Server::tick()
+{
+        arena.tick();
+
+        string *delta = new string();
+        encode_delta(*delta);
+        arena.clear_changed();
+        Frame frame(delta);
+        keyframe.reset();
+
+        for (size_t fd = 0; fd < clients.size(); fd++) {
+                Client *c = clients[fd];
+                if (c == NULL) {
+                        continue;
+                }
+                if (!frame->empty()) {
+                        queue(c, frame);
+                }
+                flush(c);
+        }
+}
+
+/* current_keyframe()
+ * Purpose: Gets the whole board for clients joining or resyncing. It is
+ *          drawn at most once per tick and shared by all of them; anything
+ *          that changes after it is drawn is in the next tick's delta.
+ * Parameters: None
+ * Returns: const Frame & (the whole board as it stands)
+ */
+const Server::Frame &Server::current_keyframe()
+{
+        if (!keyframe) {
+                string *out = new string();
+                encode_keyframe(*out);
+                keyframe.reset(out);
+        }
+        return keyframe;
+}
+
+/* encode_keyframe()
+ * Purpose: Draws the whole board, from a cleared screen, in the same layout
+ *          as Game::print().
+ * Parameters: out (buffer to append to)
+ * Returns: void
+ */
+void Server::encode_keyframe(string &out)
+{
+        out += CSI "?25l" CSI "2J";
+        arena.render(out);
+        encode_status(out);
+}
+
+/* encode_delta()
+ * Purpose: Draws only the cells changed since the last tick, each one by
+ *          moving the cursor to it and writing its glyph.
+ * Parameters: out (buffer to append to)
+ * Returns: void
+ */
+void Server::encode_delta(string &out)
+{
+        const vector<int> &changed = arena.changed();
+        int width = arena.width();
+
+        for (size_t i = 0; i < changed.size(); i++) {
+                int y = changed[i] / width, x = changed[i] % width;
+                out += CSI;
+                out += to_string(y + 2);
+                out += ';';
+                out += to_string(x + 2);
+                out += 'H';
+                arena.render_cell(y, x, out);
+        }
+
+        if (arena.player_count() != last_players ||
+            spectator_count != last_spectators) {
+                last_players = arena.player_count();
+                last_spectators = spectator_count;
+                encode_status(out);
+        }
+}
+
+/* encode_status()
+ * Purpose: Draws the line under the board showing how many are playing and
+ *          how many are watching.
+ * Parameters: out (buffer to append to)
+ * Returns: void
+ */
+void Server::encode_status(string &out)
+{
+        out += CSI;
+        out += to_string(arena.height() + 3);
+        out += ";1HPlayers: ";
+        out += to_string(arena.player_count());
+        out += "  Watching: ";
+        out += to_string(spectator_count);
+        out += CSI "K";
+}
+
+#undef CSI
@@ -0,0 +1,82 @@
+#ifndef SERVER_H_
+#define SERVER_H_
+
+#include <deque>
+#include <memory>
+#include <string>
+#include <vector>
+#include "Arena.h"
+
+/* Server
+ * Hosts one Arena for everyone connected to it. Each connection gets its
+ * own snake, steered by sending 'w', 'a', 's' or 'd'. Everything sent back
+ * is plain terminal output, so a raw-mode terminal client such as
+ *     socat -,raw,echo=0 tcp:localhost:4000
+ * is enough to play. A newly connected client is sent the whole board once,
+ * and after that only the cells that changed on each tick.
+ *
+ * Spectators connect to their own listeners and get the same stream
+ * without a snake. Every frame is encoded once into a shared, reference
+ * counted buffer; each client just queues references to them and sends
+ * its queue with a single gathered write.
+ *
+ * Runs single threaded on epoll. A client that can't keep up stops being
+ * sent deltas once its backlog passes a limit, and is sent a fresh copy of
+ * the whole board when its backlog has drained. One descriptor is held in
+ * reserve, so that when the process runs out of them a waiting connection
+ * can still be accepted and closed rather than left to wake epoll forever.
+ */
+class Server
+{
+        private:
+                typedef std::shared_ptr<const std::string> Frame;
+
+                struct Client {
+                        int fd;
+                        int player;             // -1 for a spectator
+                        bool resync;
+                        bool writable;
+                        size_t sent;            // of the first frame
+                        size_t backlog;         // bytes not yet sent
+                        std::deque<Frame> frames;
+                };
+
+                Arena &arena;
+                int tick_ms;
+                size_t backlog_limit;
+                int epoll_fd;
+                int timer_fd;
+                int spare_fd;                   // given up to shed a client
+                std::vector<int> listeners;
+                std::vector<bool> watch_only;   // per listener
+                std::vector<Client *> clients;  // indexed by fd
+                int client_count;
+                int spectator_count;
+                int last_players;
+                int last_spectators;
+                Frame keyframe;
+
+                bool add_listener(int fd, bool spectators);
+                void accept_clients(int listener, bool spectators);
+                void drop(Client *c);
+                void read_input(Client *c);
+                void flush(Client *c);
+                void queue(Client *c, const Frame &frame);
+                void tick();
+                const Frame &current_keyframe();
+                void encode_keyframe(std::string &out);
+                void encode_delta(std::string &out);
+                void encode_status(std::string &out);
+
+        public:
+                Server(Arena &game_arena, int tick_length);
+                ~Server();
+
+                bool listen_tcp(int port, const std::string &address);
+                bool listen_unix(const std::string &path);
+                bool watch_tcp(int port, const std::string &address);
+                bool watch_unix(const std::string &path);
+                void run();
+};
+
+#endif
@@ -0,0 +1,13 @@
+#ifndef SPACE_H_
+#define SPACE_H_
+
+/* Contents of a single board cell. A body cell records the side its
+ * neighbour towards the head is on, so a snake can be walked from either
+ * end without storing its segments anywhere else. WALL cells surround a
+ * board so a move never has to check the board's edges. */
+typedef enum Space {
+        HEAD = 0, BODY_FROM_UP, BODY_FROM_RIGHT, BODY_FROM_DOWN, 
+        BODY_FROM_LEFT, EMPTY, FOOD, WALL
+} Space;
+
+#endif
@@ -0,0 +1,237 @@
+#include <algorithm>
+#include <cstdlib>
+#include "Terminal.h"
+using namespace std;
+
+/* A style packs the foreground colour (bits 0-3), the background colour
+ * (bits 4-7) and a bit for each attribute that is on (from bit 8). Colour
+ * 9 is the terminal's default, as in SGR 39 and 49. */
+#define DEFAULT_STYLE (9 | 9 << 4)
+#define FG_MASK 0x0F
+#define BG_MASK 0xF0
+
+/* Constructor
+ * Purpose: Starts with a blank screen and the cursor at the top left.
+ * Parameters: None
+ * Returns: Nothing
+ */
+Terminal::Terminal()
+{
+        clear();
+}
+
+/* clear()
+ * Purpose: Blanks the whole screen and homes the cursor, as clearing a
+ *          real terminal's screen does before the game is drawn.
+ * Parameters: None
+ * Returns: void
+ */
+void Terminal::clear()
+{
+        screen.clear();
+        row = 0;
+        col = 0;
+        style = DEFAULT_STYLE;
+        last = ' ';
+}
+
+/* feed()
+ * Purpose: Follows a piece of output, changing the screen as a terminal
+ *          would.
+ * Parameters: bytes (output to follow)
+ * Returns: bool (false if it held something this model doesn't know; the
+ *          screen is then left part way through)
+ */
+bool Terminal::feed(const string &bytes)
+{
+        size_t i = 0;
+        while (i < bytes.size()) {
+                char c = bytes[i++];
+                if (c == '\r') {
+                        col = 0;
+                } else if (c == '\n') {
+                        row++;
+                } else if (c >= ' ' && c <= '~') {
+                        put(c);
+                } else if (c == '\033') {
+                        if (i >= bytes.size() || bytes[i++] != '[') {
+                                return false;
+                        }
+                        size_t start = i;
+                        while (i < bytes.size() &&
+                               ((bytes[i] >= '0' && bytes[i] <= '9') ||
+                                bytes[i] == ';')) {
+                                i++;
+                        }
+                        if (i >= bytes.size()) {
+                                return false;
+                        }
+                        string params = bytes.substr(start, i - start);
+                        char final = bytes[i++];
+                        int n = params.empty() ? 1 : atoi(params.c_str());
+                        if (!control(n, final, params)) {
+                                return false;
+                        }
+                } else {
+                        return false;
+                }
+        }
+        return true;
+}
+
+/* control()
+ * Purpose: Carries out one control sequence.
+ * Parameters: n (its number, 1 if it had none), final (its last
+ *             character), params (everything between "ESC [" and final)
+ * Returns: bool (false if it is not one this model knows)
+ */
+bool Terminal::control(int n, char final, const string &params)
+{
+        switch (final) {
+                case 'H':
+                        // Only cursor home is ever sent
+                        if (!params.empty()) {
+                                return false;
+                        }
+                        row = 0;
+                        col = 0;
+                        return true;
+                case 'm':
+                        select(params);
+                        return true;
+                case 'C':
+                        col += n;
+                        return true;
+                case 'X':
+                        // Erased cells keep just the background colour
+                        for (int j = 0; j < n; j++) {
+                                Cell &erased = at(row, col + j);
+                                erased.symbol = ' ';
+                                erased.style = (DEFAULT_STYLE & FG_MASK) |
+                                               (style & BG_MASK);
+                        }
+                        return true;
+                case 'b':
+                        for (int j = 0; j < n; j++) {
+                                put(last);
+                        }
+                        return true;
+                default:
+                        return false;
+        }
+}
+
+/* select()
+ * Purpose: Carries out SGR: changes the colours and attributes that
+ *          characters are drawn in from now on.
+ * Parameters: params (numbers separated by ';'; none means 0)
+ * Returns: void
+ */
+void Terminal::select(const string &params)
+{
+        size_t start = 0;
+        while (true) {
+                size_t end = params.find(';', start);
+                string param = params.substr(start, end == string::npos
+                                                    ? string::npos
+                                                    : end - start);
+                int code = param.empty() ? 0 : atoi(param.c_str());
+
+                if (code == 0) {
+                        style = DEFAULT_STYLE;
+                } else if (code >= 30 && code <= 39) {
+                        style = (style & ~FG_MASK) | (code - 30);
+                } else if (code >= 40 && code <= 49) {
+                        style = (style & ~BG_MASK) | (code - 40) << 4;
+                } else if (code < 10) {
+                        style |= 1 << (8 + code);
+                }
+
+                if (end == string::npos) {
+                        return;
+                }
+                start = end + 1;
+        }
+}
+
+/* put()
+ * Purpose: Draws a character at the cursor and moves the cursor on.
+ * Parameters: symbol (character to draw)
+ * Returns: void
+ */
+void Terminal::put(char symbol)
+{
+        Cell &drawn = at(row, col);
+        drawn.symbol = symbol;
+        drawn.style = style;
+        last = symbol;
+        col++;
+}
+
+/* at()
+ * Purpose: Finds a cell to change, growing the screen to reach it.
+ * Parameters: y, x (row and column, from 0)
+ * Returns: Cell & (the cell)
+ */
+Terminal::Cell &Terminal::at(int y, int x)
+{
+        if ((size_t)y >= screen.size()) {
+                screen.resize(y + 1);
+        }
+        if ((size_t)x >= screen[y].size()) {
+                Cell blank = { ' ', DEFAULT_STYLE };
+                screen[y].resize(x + 1, blank);
+        }
+        return screen[y][x];
+}
+
+/* cell()
+ * Purpose: Looks at a cell, which is blank if it was never drawn on.
+ * Parameters: y, x (row and column, from 0)
+ * Returns: Cell (the cell)
+ */
+Terminal::Cell Terminal::cell(int y, int x) const
+{
+        if ((size_t)y < screen.size() && (size_t)x < screen[y].size()) {
+                return screen[y][x];
+        }
+        Cell blank = { ' ', DEFAULT_STYLE };
+        return blank;
+}
+
+/* same()
+ * Purpose: Compares two screens cell by cell, colours included, and then
+ *          where their cursors are.
+ * Parameters: other (screen to compare with), y, x (set to the first cell
+ *             that differs, or to -1 if only the cursors do)
+ * Returns: bool (true if the screens look the same)
+ */
+bool Terminal::same(const Terminal &other, int &y, int &x) const
+{
+        size_t rows = max(screen.size(), other.screen.size());
+        for (size_t i = 0; i < rows; i++) {
+                size_t cols = max(i < screen.size() ? screen[i].size() : 0,
+                                  i < other.screen.size()
+                                  ? other.screen[i].size() : 0);
+                for (size_t j = 0; j < cols; j++) {
+                        Cell mine = cell(i, j), theirs = other.cell(i, j);
+                        if (mine.symbol != theirs.symbol ||
+                            mine.style != theirs.style) {
+                                y = i;
+                                x = j;
+                                return false;
+                        }
+                }
+        }
+
+        if (row != other.row || col != other.col) {
+                y = -1;
+                x = -1;
+                return false;
+        }
+        return true;
+}
+
+#undef DEFAULT_STYLE
+#undef FG_MASK
+#undef BG_MASK
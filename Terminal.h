@@ -0,0 +1,48 @@
+#ifndef TERMINAL_H_
+#define TERMINAL_H_
+
+#include <string>
+#include <vector>
+
+/* Terminal
+ * A model of the screen of a VT100-style terminal, for checking what is
+ * drawn rather than how. It follows the output it is fed and keeps, for
+ * every cell, the character shown there and the colours and attributes it
+ * was drawn in. It knows only what the drawing code sends: printable
+ * characters, carriage return and line feed, cursor home (CUP with no
+ * numbers), select graphic rendition (SGR), cursor forward (CUF), erase
+ * characters (ECH) and repeat (REP). Anything else makes feed() fail, so
+ * a drawing that starts sending something new is noticed.
+ *
+ * The screen has no edges: it grows to fit whatever is drawn, and cells
+ * never drawn on are blank.
+ */
+class Terminal
+{
+        private:
+                struct Cell {
+                        char symbol;
+                        int style;
+                };
+
+                std::vector<std::vector<Cell> > screen;
+                int row;
+                int col;
+                int style;              // colours and attributes to draw in
+                char last;              // last character drawn, for REP
+
+                Cell &at(int y, int x);
+                Cell cell(int y, int x) const;
+                void put(char symbol);
+                bool control(int n, char final, const std::string &params);
+                void select(const std::string &params);
+
+        public:
+                Terminal();
+
+                void clear();
+                bool feed(const std::string &bytes);
+                bool same(const Terminal &other, int &y, int &x) const;
+};
+
+#endif
@@ -0,0 +1,287 @@
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <iostream>
+#include "Tuner.h"
+using namespace std;
+
+/* Parameterized Constructor
+ * Purpose: Starts the pool of threads that play the games.
+ * Parameters: threads (size of the pool), y_dimen, x_dimen (size of every
+ *             board), games (games each candidate plays per generation),
+ *             moves (moves after which a game is stopped), seed (seed for
+ *             the search itself)
+ * Returns: Nothing
+ */
+Tuner::Tuner(int threads, int y_dimen, int x_dimen, int games, int moves,
+             uint64_t seed)
+        : rng(seed)
+{
+        y_dimension = y_dimen;
+        x_dimension = x_dimen;
+        games_each = games;
+        max_moves = moves;
+        remaining = 0;
+        generation = 0;
+        stopping = false;
+
+        for (int i = 0; i < threads; i++) {
+                workers.push_back(new Worker);
+        }
+        for (int i = 0; i < threads; i++) {
+                workers[i]->thread = thread(&Tuner::work, this, i);
+        }
+}
+
+/* Destructor
+ * Purpose: Stops the pool of threads.
+ * Parameters: None
+ * Returns: Nothing
+ */
+Tuner::~Tuner()
+{
+        {
+                lock_guard<mutex> guard(lock);
+                stopping = true;
+        }
+        started.notify_all();
+
+        for (size_t i = 0; i < workers.size(); i++) {
+                workers[i]->thread.join();
+                delete workers[i];
+        }
+}
+
+/* evolve()
+ * Purpose: Runs the search, writing a line of statistics to the file after
+ *          every generation and the best weights found at the end. Nothing
+ *          is run if the file can't be written, as the results would be
+ *          lost.
+ * Parameters: generations (how many to run), population_size (candidates
+ *             per generation), file (where to write the results), best
+ *             (set to the best candidate of the last generation)
+ * Returns: bool (false if the file could not be written)
+ */
+bool Tuner::evolve(int generations, int population_size, const string &file,
+                   Weights &best)
+{
+        ofstream out(file.c_str());
+        if (!out) {
+                cerr << "Cannot write " << file << "\n";
+                return false;
+        }
+
+        population.resize(population_size);
+        for (int i = 0; i < population_size; i++) {
+                population[i].food = noise();
+                population[i].space = noise();
+                population[i].tail = noise();
+        }
+
+        vector<double> fitness;
+        best = population[0];
+        for (int g = 0; g < generations; g++) {
+                evaluate(fitness);
+
+                int top = max_element(fitness.begin(), fitness.end()) -
+                          fitness.begin();
+                double total = 0;
+                for (int i = 0; i < population_size; i++) {
+                        total += fitness[i];
+                }
+                best = population[top];
+
+                out << "generation " << g
+                    << " best " << fitness[top]
+                    << " mean " << total / population_size
+                    << " worst " << *min_element(fitness.begin(),
+                                                 fitness.end())
+                    << " weights " << best.food << " " << best.space << " "
+                    << best.tail << endl;
+
+                if (g + 1 < generations) {
+                        breed(fitness);
+                }
+        }
+
+        out << "best " << best.food << " " << best.space << " " << best.tail
+            << endl;
+        return true;
+}
+
+/* evaluate()
+ * Purpose: Has every candidate play the generation's games on the pool,
+ *          and waits for them all.
+ * Parameters: fitness (replaced with each candidate's average length)
+ * Returns: void
+ */
+void Tuner::evaluate(vector<double> &fitness)
+{
+        int candidates = population.size();
+        int total = candidates * games_each;
+        results.assign(total, 0);
+        remaining = total;
+
+        // Every candidate plays the same games, so they are compared fairly
+        int index = 0;
+        for (int c = 0; c < candidates; c++) {
+                for (int g = 0; g < games_each; g++, index++) {
+                        Task task = { c, index,
+                                      (uint64_t)generation * games_each + g };
+                        Worker *w = workers[index % workers.size()];
+                        lock_guard<mutex> guard(w->lock);
+                        w->tasks.push_back(task);
+                }
+        }
+
+        {
+                unique_lock<mutex> guard(lock);
+                generation++;
+                started.notify_all();
+                finished.wait(guard, [this] { return remaining == 0; });
+        }
+
+        fitness.assign(candidates, 0);
+        for (int i = 0; i < total; i++) {
+                fitness[i / games_each] += results[i] / games_each;
+        }
+}
+
+/* breed()
+ * Purpose: Keeps the best quarter of the population and replaces the rest
+ *          with mixes of two of them, nudged at random.
+ * Parameters: fitness (how each candidate did)
+ * Returns: void
+ */
+void Tuner::breed(const vector<double> &fitness)
+{
+        int size = population.size();
+        vector<int> order(size);
+        for (int i = 0; i < size; i++) {
+                order[i] = i;
+        }
+        sort(order.begin(), order.end(), [&fitness](int a, int b) {
+                return fitness[a] > fitness[b];
+        });
+
+        int elite = max(1, size / 4);
+        vector<Weights> next(size);
+        for (int i = 0; i < elite; i++) {
+                next[i] = population[order[i]];
+        }
+        for (int i = elite; i < size; i++) {
+                const Weights &a = population[order[rng.below(elite)]];
+                const Weights &b = population[order[rng.below(elite)]];
+                double mix = rng.next() / 4294967296.0;
+
+                next[i].food = mix * a.food + (1 - mix) * b.food +
+                               0.1 * noise();
+                next[i].space = mix * a.space + (1 - mix) * b.space +
+                                0.1 * noise();
+                next[i].tail = mix * a.tail + (1 - mix) * b.tail +
+                               0.1 * noise();
+        }
+
+        population.swap(next);
+}
+
+/* noise()
+ * Purpose: Draws from a normal distribution (Box-Muller).
+ * Parameters: None
+ * Returns: double (mean 0, standard deviation 1)
+ */
+double Tuner::noise()
+{
+        double u = (rng.next() + 1.0) / 4294967297.0;
+        double v = rng.next() / 4294967296.0;
+        return sqrt(-2 * log(u)) * cos(2 * M_PI * v);
+}
+
+/* work()
+ * Purpose: Body of a pool thread: plays games whenever a generation
+ *          starts, until the Tuner is destroyed.
+ * Parameters: id (which worker this thread is)
+ * Returns: void
+ */
+void Tuner::work(int id)
+{
+        Game game(y_dimension, x_dimension);
+        Weights none = { 0, 0, 0 };
+        Autopilot pilot(none);
+        unsigned seen_generation = 0;
+
+        while (true) {
+                {
+                        unique_lock<mutex> guard(lock);
+                        started.wait(guard, [&] {
+                                return stopping ||
+                                       generation != seen_generation;
+                        });
+                        if (stopping) {
+                                return;
+                        }
+                        seen_generation = generation;
+                }
+
+                Task task;
+                while (take(id, task)) {
+                        pilot.set_weights(population[task.candidate]);
+                        results[task.index] = play(game, pilot, task.seed);
+
+                        if (--remaining == 0) {
+                                lock_guard<mutex> guard(lock);
+                                finished.notify_all();
+                        }
+                }
+        }
+}
+
+/* take()
+ * Purpose: Gets the next game for a worker: from the back of its own
+ *          queue, or failing that from the front of another's.
+ * Parameters: id (worker asking), task (set to the game to play)
+ * Returns: bool (false once every queue is empty)
+ */
+bool Tuner::take(int id, Task &task)
+{
+        int count = workers.size();
+
+        for (int i = 0; i < count; i++) {
+                Worker *w = workers[(id + i) % count];
+                lock_guard<mutex> guard(w->lock);
+                if (w->tasks.empty()) {
+                        continue;
+                }
+
+                if (i == 0) {
+                        task = w->tasks.back();
+                        w->tasks.pop_back();
+                } else {
+                        task = w->tasks.front();
+                        w->tasks.pop_front();
+                }
+                return true;
+        }
+
+        return false;
+}
+
+/* play()
+ * Purpose: Plays one seeded game by Autopilot, without a terminal.
+ * Parameters: game (Game to play on; reset first), pilot (Autopilot to
+ *             play with), seed (seed for the game's food)
+ * Returns: double (the Snake's length at the end)
+ */
+double Tuner::play(Game &game, Autopilot &pilot, uint64_t seed) const
+{
+        game.reset();
+        game.seed(seed);
+        game.start();
+
+        for (int move = 0; move < max_moves && !game.over(); move++) {
+                game.steer(pilot.choose(game));
+                game.step();
+        }
+
+        return game.size();
+}
@@ -0,0 +1,76 @@
+#ifndef TUNER_H_
+#define TUNER_H_
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "Autopilot.h"
+#include "Rng.h"
+
+/* Tuner
+ * Searches for good Autopilot Weights with a genetic algorithm. Every
+ * generation, each candidate plays the same set of seeded games, and its
+ * fitness is the average length its Snake reaches. The best quarter carry
+ * on unchanged, and the rest are replaced by blends of them with a little
+ * random noise.
+ *
+ * Games are shared out over a pool of threads. Each thread has its own
+ * queue of games and works from the back of it; a thread whose queue runs
+ * dry takes from the front of another's, so slow games don't hold the
+ * generation up. Each thread keeps its own Game and Autopilot and reuses
+ * them for every game it plays.
+ */
+class Tuner
+{
+        private:
+                struct Task {
+                        int candidate;
+                        int index;              // into results
+                        uint64_t seed;
+                };
+
+                struct Worker {
+                        std::mutex lock;
+                        std::deque<Task> tasks;
+                        std::thread thread;
+                };
+
+                int y_dimension;
+                int x_dimension;
+                int games_each;
+                int max_moves;
+
+                std::vector<Worker *> workers;
+                std::vector<Weights> population;
+                std::vector<double> results;    // one per game played
+                std::atomic<int> remaining;
+
+                std::mutex lock;
+                std::condition_variable started;
+                std::condition_variable finished;
+                unsigned generation;
+                bool stopping;
+                Rng rng;
+
+                void work(int id);
+                bool take(int id, Task &task);
+                double play(Game &game, Autopilot &pilot,
+                            uint64_t seed) const;
+                void evaluate(std::vector<double> &fitness);
+                void breed(const std::vector<double> &fitness);
+                double noise();
+
+        public:
+                Tuner(int threads, int y_dimen, int x_dimen, int games,
+                      int moves, uint64_t seed);
+                ~Tuner();
+
+                bool evolve(int generations, int population_size,
+                            const std::string &file, Weights &best);
+};
+
+#endif
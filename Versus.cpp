@@ -0,0 +1,489 @@
+#include <cerrno>
+#include <climits>
+#include <cstring>
+#include <ctime>
+#include <iostream>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include "Versus.h"
+#include "netfuncs.h"
+#include "termfuncs.h"
+using namespace std;
+
+#define UP 'w'
+#define LEFT 'a'
+#define DOWN 's'
+#define RIGHT 'd'
+
+// Packet types; every packet starts with one of these bytes
+#define HELLO 1
+#define START 2
+#define INPUT 3
+
+// How long without a packet before the other side is given up on
+static const long long TIMEOUT_MS = 5000;
+// How long to keep answering the other side once the game has ended
+static const long long LINGER_MS = 1000;
+
+/* now_ms()
+ * Purpose: Reads the monotonic clock.
+ * Parameters: None
+ * Returns: long long (milliseconds since an arbitrary fixed point)
+ */
+static long long now_ms()
+{
+        timespec ts;
+        clock_gettime(CLOCK_MONOTONIC, &ts);
+        return ts.tv_sec * 1000LL + ts.tv_nsec / 1000000;
+}
+
+// Packets carry numbers big endian, so the two sides needn't match
+static void put32(unsigned char *at, unsigned value)
+{
+        at[0] = value >> 24;
+        at[1] = value >> 16;
+        at[2] = value >> 8;
+        at[3] = value;
+}
+
+static unsigned get32(const unsigned char *at)
+{
+        return (unsigned)at[0] << 24 | (unsigned)at[1] << 16 |
+               (unsigned)at[2] << 8 | (unsigned)at[3];
+}
+
+/* Parameterized Constructor
+ * Purpose: Initialize a versus game that hasn't found its opponent yet.
+ * Parameters: tick_length (milliseconds between moves, if hosting)
+ * Returns: Nothing
+ */
+Versus::Versus(int tick_length)
+{
+        sock = -1;
+        me = 0;
+        tick_ms = tick_length;
+        seed = 0;
+        y_dimension = 0;
+        x_dimension = 0;
+        arena = NULL;
+        frame = 0;
+        confirmed = -1;
+        acked = -1;
+        rollback_from = INT_MAX;
+        ended_at = INT_MAX;
+        last_heard = 0;
+}
+
+/* Destructor
+ * Purpose: Closes the socket and frees the game.
+ * Parameters: None
+ * Returns: Nothing
+ */
+Versus::~Versus()
+{
+        if (sock >= 0) {
+                close(sock);
+        }
+        delete arena;
+}
+
+/* host()
+ * Purpose: Waits for an opponent to join on a UDP port, then tells them the
+ *          board size, speed and seed for the game.
+ * Parameters: port (port to wait on), address (address to bind to),
+ *             y_dimen, x_dimen (board size)
+ * Returns: bool (true once an opponent has joined)
+ */
+bool Versus::host(int port, const string &address, int y_dimen, int x_dimen)
+{
+        sock = bind_udp(port, address);
+        if (sock < 0) {
+                return false;
+        }
+
+        me = 0;
+        y_dimension = y_dimen;
+        x_dimension = x_dimen;
+        seed = time(NULL);
+
+        cout << "Waiting for an opponent on port " << port << "..." << endl;
+        while (true) {
+                pollfd p = { sock, POLLIN, 0 };
+                if (poll(&p, 1, -1) < 0 && errno != EINTR) {
+                        return false;
+                }
+
+                unsigned char data[16];
+                sockaddr_storage from;
+                socklen_t length = sizeof(from);
+                ssize_t n = recvfrom(sock, data, sizeof(data), 0,
+                                     (sockaddr *)&from, &length);
+                if (n >= 1 && data[0] == HELLO) {
+                        // From now on only talk to this opponent
+                        connect(sock, (sockaddr *)&from, length);
+                        break;
+                }
+        }
+
+        send_start();
+        start_game();
+        return true;
+}
+
+/* join()
+ * Purpose: Joins a game hosted by another process, asking until it answers.
+ * Parameters: host_name (where the game is hosted), port (its port)
+ * Returns: bool (true once the host has answered)
+ */
+bool Versus::join(const string &host_name, int port)
+{
+        sock = connect_udp(host_name, port);
+        if (sock < 0) {
+                return false;
+        }
+
+        me = 1;
+        cout << "Joining " << host_name << ":" << port << "..." << endl;
+        for (int tries = 0; tries < 50; tries++) {
+                unsigned char hello = HELLO;
+                ::send(sock, &hello, 1, 0);
+
+                pollfd p = { sock, POLLIN, 0 };
+                if (poll(&p, 1, 200) <= 0) {
+                        continue;
+                }
+
+                unsigned char data[16];
+                ssize_t n = recv(sock, data, sizeof(data), 0);
+                if (n == 11 && data[0] == START) {
+                        seed = get32(data + 1);
+                        y_dimension = data[5] << 8 | data[6];
+                        x_dimension = data[7] << 8 | data[8];
+                        tick_ms = data[9] << 8 | data[10];
+                        start_game();
+                        return true;
+                }
+        }
+
+        return false;
+}
+
+/* run()
+ * Purpose: Plays the game until one snake dies, then shows who won. Each
+ *          tick runs on the local keys and a guess at the other side's,
+ *          fixing up the past whenever the guess turns out wrong.
+ * Parameters: None
+ * Returns: void
+ */
+void Versus::run()
+{
+        long long next = now_ms();
+        long long ended = 0;
+        char key = '\0';
+
+        hide_cursor();
+        screen_clear();
+        last_heard = now_ms();
+
+        while (ended == 0 || now_ms() - ended < LINGER_MS) {
+                // Take keys and packets until the next tick is due
+                while (now_ms() < next) {
+                        char c = getacharnow(0);
+                        if (c == UP || c == DOWN || c == LEFT || c == RIGHT) {
+                                key = c;
+                        } else if (c == 'q') {
+                                ended = now_ms() - LINGER_MS;
+                        }
+                        receive();
+                        usleep(2000);
+                }
+                next += tick_ms;
+
+                receive();
+                rollback();
+                if (ended == 0 && can_advance()) {
+                        advance(key);
+                        key = '\0';
+                }
+                send_inputs();
+                print();
+
+                if (ended == 0 && result() >= 0) {
+                        ended = now_ms();
+                }
+                if (ended == 0 && now_ms() - last_heard > TIMEOUT_MS) {
+                        cout << "Lost contact with the other player." << endl;
+                        break;
+                }
+        }
+
+        switch (result()) {
+                case 0:
+                case 1:
+                        cout << (result() == me ? "You won!" : "You lost!")
+                             << endl;
+                        break;
+                case 2:
+                        cout << "It's a draw!" << endl;
+                        break;
+                default:
+                        break;
+        }
+        show_cursor();
+}
+
+/* start_game()
+ * Purpose: Sets up the board both sides will play on. Built from the same
+ *          seed, it comes out the same on both.
+ * Parameters: None
+ * Returns: void
+ */
+void Versus::start_game()
+{
+        arena = new Arena(y_dimension, x_dimension, seed);
+        arena->add_player();
+        arena->add_player();
+        arena->clear_changed();
+
+        states.assign(RING, *arena);
+        memset(inputs, 0, sizeof(inputs));
+        frame = 0;
+        confirmed = -1;
+        acked = -1;
+        rollback_from = INT_MAX;
+        ended_at = INT_MAX;
+}
+
+/* simulate()
+ * Purpose: Runs one tick of the game on the keys recorded for it. Once a
+ *          snake has died the board stays as it was at that tick, so both
+ *          sides end on the same board however far each had guessed ahead.
+ * Parameters: f (tick to run)
+ * Returns: void
+ */
+void Versus::simulate(int f)
+{
+        if (ended_at < f) {
+                return;
+        }
+
+        for (int player = 0; player < 2; player++) {
+                char key = inputs[player][f % INPUTS];
+                // A key from a dead player would respawn it in an Arena
+                if (key != '\0' && arena->alive(player)) {
+                        arena->steer(player, key);
+                }
+        }
+        arena->tick();
+        arena->clear_changed();
+
+        if (!arena->alive(0) || !arena->alive(1)) {
+                ended_at = f;
+        }
+}
+
+/* can_advance()
+ * Purpose: Checks if another tick can be run. Not if it would get too far
+ *          ahead of the other side to undo, nor while a snake is dead but
+ *          its death hasn't been confirmed by the other side's keys.
+ * Parameters: None
+ * Returns: bool (true if the next tick can be run)
+ */
+bool Versus::can_advance() const
+{
+        return frame - confirmed < RING - 1 && frame - acked < INPUTS - 1 &&
+               arena->alive(0) && arena->alive(1);
+}
+
+/* advance()
+ * Purpose: Runs the next tick with the local key and, unless it has already
+ *          arrived, a guess that the other side pressed nothing. The state
+ *          before the tick is saved in case the guess is wrong.
+ * Parameters: key (direction pressed locally this tick, or '\0')
+ * Returns: void
+ */
+void Versus::advance(char key)
+{
+        inputs[me][frame % INPUTS] = key;
+        if (frame > confirmed) {
+                inputs[1 - me][frame % INPUTS] = '\0';
+        }
+
+        states[frame % RING] = *arena;
+        simulate(frame);
+        frame++;
+}
+
+/* receive()
+ * Purpose: Handles every packet waiting on the socket.
+ * Parameters: None
+ * Returns: void
+ */
+void Versus::receive()
+{
+        unsigned char data[128];
+        ssize_t n;
+
+        while ((n = recv(sock, data, sizeof(data), MSG_DONTWAIT)) > 0) {
+                last_heard = now_ms();
+                handle_packet(data, n);
+        }
+}
+
+/* handle_packet()
+ * Purpose: Records the other side's keys from a packet. A key for a tick
+ *          that already ran on a different guess marks the game to be
+ *          played again from that tick.
+ * Parameters: data (packet received), length (its size in bytes)
+ * Returns: void
+ */
+void Versus::handle_packet(const unsigned char *data, int length)
+{
+        if (data[0] == HELLO && me == 0) {
+                // Our START was lost
+                send_start();
+                return;
+        }
+        if (data[0] != INPUT || length < 10) {
+                return;
+        }
+
+        int first = get32(data + 1);
+        int count = data[5];
+        int ack = (int)get32(data + 6) - 1;
+        if (length < 10 + count) {
+                return;
+        }
+
+        if (ack > acked) {
+                acked = ack;
+        }
+        for (int i = 0; i < count; i++) {
+                int f = first + i;
+                if (f != confirmed + 1) {
+                        continue;
+                }
+
+                char key = data[10 + i];
+                char &slot = inputs[1 - me][f % INPUTS];
+                if (f < frame && key != slot && f < rollback_from) {
+                        rollback_from = f;
+                }
+                slot = key;
+                confirmed = f;
+        }
+}
+
+/* rollback()
+ * Purpose: If a guess was wrong, puts the game back to the first tick
+ *          guessed wrong and runs every tick since then again.
+ * Parameters: None
+ * Returns: void
+ */
+void Versus::rollback()
+{
+        if (rollback_from >= frame) {
+                rollback_from = INT_MAX;
+                return;
+        }
+
+        *arena = states[rollback_from % RING];
+        if (ended_at >= rollback_from) {
+                ended_at = INT_MAX;
+        }
+        for (int f = rollback_from; f < frame; f++) {
+                states[f % RING] = *arena;
+                simulate(f);
+        }
+        rollback_from = INT_MAX;
+}
+
+/* send_inputs()
+ * Purpose: Sends every local key the other side hasn't acknowledged, along
+ *          with how many of its keys have arrived here. Sent every tick, so
+ *          a lost packet is made up for by the next one.
+ * Parameters: None
+ * Returns: void
+ */
+void Versus::send_inputs()
+{
+        unsigned char data[10 + INPUTS];
+        int first = acked + 1;
+        int count = frame - first;
+
+        data[0] = INPUT;
+        put32(data + 1, first);
+        data[5] = count;
+        put32(data + 6, confirmed + 1);
+        for (int i = 0; i < count; i++) {
+                data[10 + i] = inputs[me][(first + i) % INPUTS];
+        }
+        ::send(sock, data, 10 + count, 0);
+}
+
+/* send_start()
+ * Purpose: Tells the joining side the seed, board size and speed.
+ * Parameters: None
+ * Returns: void
+ */
+void Versus::send_start()
+{
+        unsigned char data[11];
+
+        data[0] = START;
+        put32(data + 1, seed);
+        data[5] = y_dimension >> 8;
+        data[6] = y_dimension;
+        data[7] = x_dimension >> 8;
+        data[8] = x_dimension;
+        data[9] = tick_ms >> 8;
+        data[10] = tick_ms;
+        ::send(sock, data, sizeof(data), 0);
+}
+
+/* print()
+ * Purpose: Prints the board and both players' sizes.
+ * Parameters: None
+ * Returns: void
+ */
+void Versus::print() const
+{
+        string out;
+        arena->render(out);
+
+        out += "You: " + to_string(arena->size_of(me));
+        out += "  Them: " + to_string(arena->size_of(1 - me));
+        if (frame - confirmed >= RING - 1) {
+                out += "  (waiting for the other player)";
+        }
+        out += "\033[K\r\n";
+        cout << out << flush;
+}
+
+/* result()
+ * Purpose: Decides the game, once a death has been confirmed by the other
+ *          side's keys and so can no longer be undone.
+ * Parameters: None
+ * Returns: int (the winning player, 2 for a draw, or -1 if undecided)
+ */
+int Versus::result() const
+{
+        bool alive0 = arena->alive(0), alive1 = arena->alive(1);
+        if (ended_at == INT_MAX || confirmed < ended_at) {
+                return -1;
+        }
+        if (!alive0 && !alive1) {
+                return 2;
+        }
+        return alive0 ? 0 : 1;
+}
+
+#undef UP
+#undef LEFT
+#undef DOWN
+#undef RIGHT
+
+#undef HELLO
+#undef START
+#undef INPUT
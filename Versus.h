@@ -0,0 +1,64 @@
+#ifndef VERSUS_H_
+#define VERSUS_H_
+
+#include <string>
+#include <vector>
+#include "Arena.h"
+
+/* Versus
+ * Head-to-head play between two processes over UDP. Both sides run the same
+ * deterministic two-snake Arena from a shared seed, and only key presses
+ * are sent. Rather than wait a round trip for the other player's keys each
+ * tick, a side guesses the other player pressed nothing and carries on.
+ * The state before every tick is kept in a ring, so when a key turns up
+ * for a tick that was guessed wrong, the game is put back to that tick and
+ * played forward again with the real keys.
+ */
+class Versus
+{
+        private:
+                // Ticks a side may run ahead of the other's confirmed keys
+                static const int RING = 16;
+                // Own keys kept for resending until the other side has them
+                static const int INPUTS = 64;
+
+                int sock;
+                int me;
+                int tick_ms;
+                unsigned seed;
+                int y_dimension;
+                int x_dimension;
+
+                Arena *arena;
+                std::vector<Arena> states;      // before tick f, at f % RING
+                char inputs[2][INPUTS];         // key for tick f, at f % INPUTS
+                int frame;                      // next tick to run
+                int confirmed;                  // other side's keys known to
+                int acked;                      // own keys received up to
+                int rollback_from;
+                int ended_at;                   // tick a snake died on
+                long long last_heard;
+
+                void start_game();
+                void simulate(int f);
+                bool can_advance() const;
+                void advance(char key);
+                void receive();
+                void handle_packet(const unsigned char *data, int length);
+                void rollback();
+                void send_inputs();
+                void send_start();
+                void print() const;
+                int result() const;
+
+        public:
+                Versus(int tick_length);
+                ~Versus();
+
+                bool host(int port, const std::string &address, int y_dimen,
+                          int x_dimen);
+                bool join(const std::string &host_name, int port);
+                void run();
+};
+
+#endif
@@ -0,0 +1,209 @@
+#include <algorithm>
+#include <unistd.h>
+#include "Game.h"
+#include "Glyphs.h"
+#include "Space.h"
+#include "Wall.h"
+#include "termfuncs.h"
+using namespace std;
+
+// Which Space a shrunk block shows: the one ranked highest here
+static const int RANK[] = {
+        5,              // HEAD
+        4, 4, 4, 4,     // BODY_FROM_*
+        1,              // EMPTY
+        3,              // FOOD
+        2               // WALL
+};
+
+/* cursor_to()
+ * Purpose: Moves the cursor to a place on the screen.
+ * Parameters: row, col (place to move to, counting from 1), out (buffer to
+ *             append the escape sequence to)
+ * Returns: void
+ */
+static void cursor_to(int row, int col, string &out)
+{
+        out += "\033[";
+        out += to_string(row);
+        out += ';';
+        out += to_string(col);
+        out += 'H';
+}
+
+/* Constructor
+ * Purpose: Creates an empty wall.
+ * Parameters: None
+ * Returns: Nothing
+ */
+Wall::Wall()
+{
+        screen_rows = 0;
+        screen_cols = 0;
+        columns = 1;
+        tile_rows = 0;
+        tile_cols = 0;
+}
+
+/* add()
+ * Purpose: Adds a game to the wall, in the next tile.
+ * Parameters: game (Game to show; must outlive the Wall)
+ * Returns: void
+ */
+void Wall::add(const Game *game)
+{
+        Tile tile = { game, 0, false };
+        tiles.push_back(tile);
+        screen_rows = 0;
+}
+
+/* refresh()
+ * Purpose: Brings the screen up to date with a single write.
+ * Parameters: None
+ * Returns: void
+ */
+void Wall::refresh()
+{
+        out.clear();
+        render(out);
+
+        size_t done = 0;
+        while (done < out.size()) {
+                ssize_t n = write(STDOUT_FILENO, out.data() + done,
+                                  out.size() - done);
+                if (n <= 0) {
+                        return;
+                }
+                done += n;
+        }
+}
+
+/* render()
+ * Purpose: Draws every tile whose game has changed since it was last drawn,
+ *          after laying the wall out again if the screen size changed.
+ * Parameters: buffer (buffer to append the drawing to)
+ * Returns: void
+ */
+void Wall::render(string &buffer)
+{
+        int rows = get_screen_rows(), cols = get_screen_cols();
+        if (rows <= 0 || cols <= 0) {
+                rows = 24;
+                cols = 80;
+        }
+        if (rows != screen_rows || cols != screen_cols) {
+                layout(rows, cols);
+                buffer += "\033[H\033[2J";
+        }
+
+        for (size_t t = 0; t < tiles.size(); t++) {
+                if (!tiles[t].drawn ||
+                    tiles[t].version != tiles[t].game->version()) {
+                        draw(t, buffer);
+                }
+        }
+}
+
+/* layout()
+ * Purpose: Picks how many tiles go across the screen, so the boards need
+ *          shrinking as little as possible.
+ * Parameters: rows, cols (size of the screen)
+ * Returns: void
+ */
+void Wall::layout(int rows, int cols)
+{
+        int count = max((int)tiles.size(), 1);
+        int y_dimen = 1, x_dimen = 1;
+        for (size_t t = 0; t < tiles.size(); t++) {
+                y_dimen = max(y_dimen, tiles[t].game->height());
+                x_dimen = max(x_dimen, tiles[t].game->width());
+        }
+
+        screen_rows = rows;
+        screen_cols = cols;
+        columns = 1;
+        tile_rows = max(rows - 1, 1);
+        tile_cols = cols;
+
+        // A column between tiles, and a line under each for its label
+        double best = -1;
+        for (int across = 1; across <= count && across <= cols / 2;
+             across++) {
+                int down = (count + across - 1) / across;
+                int width = (cols + 1) / across - 1;
+                int height = rows / down - 1;
+                if (width < 1 || height < 1) {
+                        continue;
+                }
+
+                double scale = min(min((double)width / x_dimen,
+                                       (double)height / y_dimen), 1.0);
+                if (scale > best) {
+                        best = scale;
+                        columns = across;
+                        tile_rows = height;
+                        tile_cols = width;
+                }
+        }
+
+        for (size_t t = 0; t < tiles.size(); t++) {
+                tiles[t].drawn = false;
+        }
+}
+
+/* draw()
+ * Purpose: Draws one tile: its board, shrunk to fit if need be, and its
+ *          label. Tiles that would fall off the bottom of the screen are
+ *          left out.
+ * Parameters: t (tile to draw), out (buffer to append the drawing to)
+ * Returns: void
+ */
+void Wall::draw(int t, string &out)
+{
+        Tile &tile = tiles[t];
+        const Game &game = *tile.game;
+        int top = (t / columns) * (tile_rows + 1) + 1;
+        int left = (t % columns) * (tile_cols + 1) + 1;
+        if (top + tile_rows > screen_rows) {
+                return;
+        }
+
+        int y_dimen = game.height(), x_dimen = game.width();
+        int block_y = (y_dimen + tile_rows - 1) / tile_rows;
+        int block_x = (x_dimen + tile_cols - 1) / tile_cols;
+        int shown_rows = (y_dimen + block_y - 1) / block_y;
+        int shown_cols = (x_dimen + block_x - 1) / block_x;
+        scratch.resize(shown_cols);
+
+        for (int r = 0; r < shown_rows; r++) {
+                cursor_to(top + r, left, out);
+                if (block_y == 1 && block_x == 1) {
+                        encode_row(game.cells_in_row(r), x_dimen, out,
+                                   RUN_ERASE);
+                        continue;
+                }
+
+                fill(scratch.begin(), scratch.end(), (unsigned char)EMPTY);
+                int last_row = min((r + 1) * block_y, y_dimen);
+                for (int i = r * block_y; i < last_row; i++) {
+                        const unsigned char *cells = game.cells_in_row(i);
+                        for (int j = 0; j < x_dimen; j++) {
+                                unsigned char &shown = scratch[j / block_x];
+                                if (RANK[cells[j]] > RANK[shown]) {
+                                        shown = cells[j];
+                                }
+                        }
+                }
+                encode_row(&scratch[0], shown_cols, out, RUN_ERASE);
+        }
+
+        string label = "#" + to_string(t) +
+                       (game.over() ? " over " : " ") +
+                       to_string(game.size());
+        label.resize(tile_cols, ' ');
+        cursor_to(top + tile_rows, left, out);
+        out += label;
+
+        tile.version = game.version();
+        tile.drawn = true;
+}
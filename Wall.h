@@ -0,0 +1,50 @@
+#ifndef WALL_H_
+#define WALL_H_
+
+#include <string>
+#include <vector>
+
+class Game;
+
+/* Wall
+ * Shows many Games at once in one terminal, each in its own tile of a grid
+ * laid out to fit the screen. A board too big for its tile is shrunk: each
+ * character stands for a block of cells, and shows the most important
+ * thing in the block (head, then body, then food, then wall), so Snakes
+ * never disappear. Under each board is a line with the game's number and
+ * size.
+ *
+ * refresh() only redraws tiles whose game has changed since it last looked
+ * (going by Game::version()), and sends the whole update with one write.
+ * If the screen has been resized, everything is laid out again.
+ */
+class Wall
+{
+        private:
+                struct Tile {
+                        const Game *game;
+                        unsigned version;       // when last drawn
+                        bool drawn;
+                };
+
+                std::vector<Tile> tiles;
+                int screen_rows;
+                int screen_cols;
+                int columns;            // tiles across
+                int tile_rows;          // board rows in a tile
+                int tile_cols;
+                std::vector<unsigned char> scratch;     // a shrunk row
+                std::string out;
+
+                void layout(int rows, int cols);
+                void draw(int t, std::string &out);
+
+        public:
+                Wall();
+
+                void add(const Game *game);
+                void render(std::string &buffer);
+                void refresh();
+};
+
+#endif
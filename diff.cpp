@@ -0,0 +1,131 @@
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+#include <iostream>
+#include <thread>
+#include <unistd.h>
+#include "Differ.h"
+using namespace std;
+
+/* show()
+ * Purpose: Prints a trace in the form -r takes: seed:rows:cols:food:keys,
+ *          with '.' for a move with no key.
+ * Parameters: trace (trace to print)
+ * Returns: void
+ */
+static void show(const Trace &trace)
+{
+        string keys = trace.keys;
+        for (size_t i = 0; i < keys.size(); i++) {
+                if (keys[i] == '\0') {
+                        keys[i] = '.';
+                }
+        }
+        cout << trace.seed << ":" << trace.y_dimension << ":"
+             << trace.x_dimension << ":" << trace.food_at_once << ":" << keys
+             << "\n";
+}
+
+/* Usage: snake_diff [-n games] [-j threads] [-y rows] [-x cols]
+ *                   [-m moves] [-s seed] [-r trace]
+ * Checks that Game plays exactly as the frozen Reference does (see Differ),
+ * over random games on every core. If they ever differ, the game is shrunk
+ * to as few moves as still show it, and printed with what differed; the
+ * printed trace can be played again with -r. Exits with 1 if a difference
+ * was found. */
+int main(int argc, char *argv[])
+{
+        long long games = 1000000;
+        int threads = thread::hardware_concurrency();
+        int rows = 24, cols = 80, moves = 2000;
+        uint64_t seed = time(NULL);
+        string replay;
+        int opt;
+
+        while ((opt = getopt(argc, argv, "n:j:y:x:m:s:r:")) != -1) {
+                switch (opt) {
+                        case 'n':
+                                games = atoll(optarg);
+                                break;
+                        case 'j':
+                                threads = atoi(optarg);
+                                break;
+                        case 'y':
+                                rows = atoi(optarg);
+                                break;
+                        case 'x':
+                                cols = atoi(optarg);
+                                break;
+                        case 'm':
+                                moves = atoi(optarg);
+                                break;
+                        case 's':
+                                seed = strtoull(optarg, NULL, 10);
+                                break;
+                        case 'r':
+                                replay = optarg;
+                                break;
+                        default:
+                                cerr << "Usage: " << argv[0] << " [-n games] "
+                                     << "[-j threads] [-y rows] [-x cols] "
+                                     << "[-m moves] [-s seed] [-r trace]\n";
+                                return EXIT_FAILURE;
+                }
+        }
+
+        Differ differ(seed, rows, cols, moves);
+        Trace trace;
+        string why;
+
+        if (!replay.empty()) {
+                unsigned long long trace_seed;
+                int used = 0;
+                if (sscanf(replay.c_str(), "%llu:%d:%d:%d:%n", &trace_seed,
+                           &trace.y_dimension, &trace.x_dimension,
+                           &trace.food_at_once, &used) != 4 || used == 0 ||
+                    trace.y_dimension < 2 || trace.x_dimension < 2) {
+                        cerr << "A trace is seed:rows:cols:food:keys.\n";
+                        return EXIT_FAILURE;
+                }
+                trace.seed = trace_seed;
+                trace.keys = replay.substr(used);
+                for (size_t i = 0; i < trace.keys.size(); i++) {
+                        if (trace.keys[i] == '.') {
+                                trace.keys[i] = '\0';
+                        }
+                }
+
+                if (Differ::play(trace, NULL, 0, why) < 0) {
+                        cout << "Same on both engines.\n";
+                        return 0;
+                }
+                cout << why << "\n";
+                return 1;
+        }
+
+        cout << "Seed " << seed << ", " << games << " games on " << threads
+             << " threads.\n";
+        auto began = chrono::steady_clock::now();
+        bool same = differ.run(games, threads);
+        double seconds = chrono::duration<double>(
+                chrono::steady_clock::now() - began).count();
+
+        cout << differ.played() << " games, " << differ.moves()
+             << " moves in " << seconds << " s ("
+             << (long long)(differ.played() / seconds * 60)
+             << " games a minute).\n";
+        if (same) {
+                cout << "Game and Reference agree.\n";
+                return 0;
+        }
+
+        trace = differ.failed();
+        cout << "Game and Reference differ after " << trace.keys.size()
+             << " moves; shrinking.\n";
+        differ.shrink(trace);
+        Differ::play(trace, NULL, 0, why);
+        cout << why << "\n";
+        show(trace);
+        return 1;
+}
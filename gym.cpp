@@ -0,0 +1,58 @@
+#include <iostream>
+#include <cstdlib>
+#include <ctime>
+#include <unistd.h>
+#include "Gym.h"
+#include "termfuncs.h"
+using namespace std;
+
+/* Usage: snake_gym [-f file] [-n games] [-r slots] [-y rows] [-x cols]
+ *                  [-s seed]
+ * Plays a batch of games for a training process through a shared memory
+ * file, by default /dev/shm/snake_gym with 1024 games on 10 by 40 boards
+ * and 4 steps in the ring. See Gym.h for the layout of the file. */
+int main(int argc, char *argv[])
+{
+        string file = "/dev/shm/snake_gym";
+        int envs = 1024, slots = 4, rows = 10, cols = 40;
+        unsigned seed = time(NULL);
+        int opt;
+
+        while ((opt = getopt(argc, argv, "f:n:r:y:x:s:")) != -1) {
+                switch (opt) {
+                        case 'f':
+                                file = optarg;
+                                break;
+                        case 'n':
+                                envs = atoi(optarg);
+                                break;
+                        case 'r':
+                                slots = atoi(optarg);
+                                break;
+                        case 'y':
+                                rows = atoi(optarg);
+                                break;
+                        case 'x':
+                                cols = atoi(optarg);
+                                break;
+                        case 's':
+                                seed = strtoul(optarg, NULL, 10);
+                                break;
+                        default:
+                                cerr << "Usage: " << argv[0] << " [-f file] "
+                                     << "[-n games] [-r slots] [-y rows] "
+                                     << "[-x cols] [-s seed]\n";
+                                return EXIT_FAILURE;
+                }
+        }
+
+        Gym gym(envs, slots);
+        if (!gym.open(file, rows, cols, seed)) {
+                cerr << "Could not set up " << file << ".\n";
+                return EXIT_FAILURE;
+        }
+        catch_interrupts();
+        gym.run();
+
+        return 0;
+}
@@ -0,0 +1,84 @@
+#include <iostream>
+#include <cstdlib>
+#include <unistd.h>
+#include "Host.h"
+#include "Metrics.h"
+#include "Scores.h"
+using namespace std;
+
+/* Usage: snake_host [-p port] [-u socket_path] [-b address] [-y rows]
+ *                   [-x cols] [-m metrics_path] [-s scores_file]
+ * With neither -p nor -u given, listens on TCP port 4001, on the loopback
+ * address unless -b gives another (0.0.0.0 for every interface). With -m,
+ * metrics are served in Prometheus text format on that Unix socket. With
+ * -s, players are asked for a name, and every game's score is recorded
+ * under it in that file (see snake_scores). */
+int main(int argc, char *argv[])
+{
+        int port = -1, rows = 10, cols = 40;
+        string path, metrics_path, scores_file, address = "127.0.0.1";
+        int opt;
+
+        while ((opt = getopt(argc, argv, "p:u:b:y:x:m:s:")) != -1) {
+                switch (opt) {
+                        case 'p':
+                                port = atoi(optarg);
+                                break;
+                        case 'u':
+                                path = optarg;
+                                break;
+                        case 'b':
+                                address = optarg;
+                                break;
+                        case 'y':
+                                rows = atoi(optarg);
+                                break;
+                        case 'x':
+                                cols = atoi(optarg);
+                                break;
+                        case 'm':
+                                metrics_path = optarg;
+                                break;
+                        case 's':
+                                scores_file = optarg;
+                                break;
+                        default:
+                                cerr << "Usage: " << argv[0] << " [-p port] "
+                                     << "[-u socket_path] [-b address] "
+                                     << "[-y rows] [-x cols] "
+                                     << "[-m metrics_path] "
+                                     << "[-s scores_file]\n";
+                                return EXIT_FAILURE;
+                }
+        }
+        if (port < 0 && path.empty()) {
+                port = 4001;
+        }
+
+        Host host(rows, cols);
+        if (port >= 0 && !host.listen_tcp(port, address)) {
+                cerr << "Could not listen on port " << port << ".\n";
+                return EXIT_FAILURE;
+        }
+        if (!path.empty() && !host.listen_unix(path)) {
+                cerr << "Could not listen on " << path << ".\n";
+                return EXIT_FAILURE;
+        }
+        if (!metrics_path.empty() && !Metrics::serve(metrics_path)) {
+                cerr << "Could not serve metrics on " << metrics_path
+                     << ".\n";
+                return EXIT_FAILURE;
+        }
+        Scores scores;
+        if (!scores_file.empty()) {
+                if (!scores.open(scores_file)) {
+                        cerr << "Cannot open scores " << scores_file
+                             << ".\n";
+                        return EXIT_FAILURE;
+                }
+                host.set_scores(&scores);
+        }
+        host.run();
+
+        return 0;
+}
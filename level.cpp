@@ -0,0 +1,46 @@
+#include <iostream>
+#include <cstdlib>
+#include <unistd.h>
+#include "Level.h"
+using namespace std;
+
+/* Usage: snake_level [-f food] [-s speed] [-m min_speed] drawing level
+ * Turns a drawing of a board into a level file for SNAKE_LEVEL. In the
+ * drawing '#' is a wall or obstacle and '@' is where the Snake starts; the
+ * board is walled in all round without drawing it. By
+ * default one food is out at a time, and the delay between moves starts at
+ * 50 and drops to 20 hundredths of a second, as on the usual board. */
+int main(int argc, char *argv[])
+{
+        int food_at_once = 1, start_speed = 50, min_speed = 20;
+        int opt;
+
+        while ((opt = getopt(argc, argv, "f:s:m:")) != -1) {
+                switch (opt) {
+                        case 'f':
+                                food_at_once = atoi(optarg);
+                                break;
+                        case 's':
+                                start_speed = atoi(optarg);
+                                break;
+                        case 'm':
+                                min_speed = atoi(optarg);
+                                break;
+                        default:
+                                optind = argc + 1;
+                                break;
+                }
+        }
+        if (optind + 2 != argc) {
+                cerr << "Usage: " << argv[0] << " [-f food] [-s speed] "
+                     << "[-m min_speed] drawing level\n";
+                return EXIT_FAILURE;
+        }
+
+        if (!Level::build(argv[optind], argv[optind + 1], food_at_once,
+                          start_speed, min_speed)) {
+                return EXIT_FAILURE;
+        }
+
+        return 0;
+}
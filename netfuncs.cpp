@@ -0,0 +1,139 @@
+#include <cerrno>
+#include <cstring>
+#include <arpa/inet.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include "netfuncs.h"
+using namespace std;
+
+/* listen_tcp()
+ * Purpose: Opens a nonblocking TCP listening socket on the given port.
+ * Parameters: port (port number to listen on), address (IPv4 address to
+ *             bind to; "0.0.0.0" for every interface)
+ * Returns: int (listening file descriptor, or -1 on failure)
+ */
+int listen_tcp(int port, const string &address)
+{
+        sockaddr_in addr;
+        memset(&addr, 0, sizeof(addr));
+        addr.sin_family = AF_INET;
+        addr.sin_port = htons(port);
+        if (inet_pton(AF_INET, address.c_str(), &addr.sin_addr) != 1) {
+                errno = EINVAL;
+                return -1;
+        }
+
+        int fd = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC,
+                        0);
+        if (fd < 0) {
+                return -1;
+        }
+
+        int on = 1;
+        setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &on, sizeof(on));
+
+        if (bind(fd, (sockaddr *)&addr, sizeof(addr)) < 0 ||
+            listen(fd, SOMAXCONN) < 0) {
+                close(fd);
+                return -1;
+        }
+
+        return fd;
+}
+
+/* listen_unix()
+ * Purpose: Opens a nonblocking Unix domain listening socket at path,
+ *          replacing any stale socket file left behind by an earlier run.
+ * Parameters: path (file system path of the socket)
+ * Returns: int (listening file descriptor, or -1 on failure)
+ */
+int listen_unix(const string &path)
+{
+        sockaddr_un addr;
+        if (path.size() >= sizeof(addr.sun_path)) {
+                return -1;
+        }
+
+        int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC,
+                        0);
+        if (fd < 0) {
+                return -1;
+        }
+
+        memset(&addr, 0, sizeof(addr));
+        addr.sun_family = AF_UNIX;
+        strcpy(addr.sun_path, path.c_str());
+        unlink(path.c_str());
+
+        if (bind(fd, (sockaddr *)&addr, sizeof(addr)) < 0 ||
+            listen(fd, SOMAXCONN) < 0) {
+                close(fd);
+                return -1;
+        }
+
+        return fd;
+}
+
+/* bind_udp()
+ * Purpose: Opens a nonblocking UDP socket bound to the given port.
+ * Parameters: port (port number to receive on), address (IPv4 address to
+ *             bind to; "0.0.0.0" for every interface)
+ * Returns: int (socket file descriptor, or -1 on failure)
+ */
+int bind_udp(int port, const string &address)
+{
+        sockaddr_in addr;
+        memset(&addr, 0, sizeof(addr));
+        addr.sin_family = AF_INET;
+        addr.sin_port = htons(port);
+        if (inet_pton(AF_INET, address.c_str(), &addr.sin_addr) != 1) {
+                errno = EINVAL;
+                return -1;
+        }
+
+        int fd = socket(AF_INET, SOCK_DGRAM | SOCK_NONBLOCK | SOCK_CLOEXEC,
+                        0);
+        if (fd < 0) {
+                return -1;
+        }
+
+        if (bind(fd, (sockaddr *)&addr, sizeof(addr)) < 0) {
+                close(fd);
+                return -1;
+        }
+
+        return fd;
+}
+
+/* connect_udp()
+ * Purpose: Opens a nonblocking UDP socket that sends to, and only receives
+ *          from, host:port.
+ * Parameters: host (name or address of the peer), port (its port)
+ * Returns: int (socket file descriptor, or -1 on failure)
+ */
+int connect_udp(const string &host, int port)
+{
+        addrinfo hints;
+        addrinfo *found;
+        memset(&hints, 0, sizeof(hints));
+        hints.ai_family = AF_INET;
+        hints.ai_socktype = SOCK_DGRAM;
+
+        string service = to_string(port);
+        if (getaddrinfo(host.c_str(), service.c_str(), &hints, &found) != 0) {
+                return -1;
+        }
+
+        int fd = socket(AF_INET, SOCK_DGRAM | SOCK_NONBLOCK | SOCK_CLOEXEC,
+                        0);
+        if (fd >= 0 && connect(fd, found->ai_addr, found->ai_addrlen) < 0) {
+                close(fd);
+                fd = -1;
+        }
+        freeaddrinfo(found);
+
+        return fd;
+}
@@ -0,0 +1,24 @@
+#ifndef NETFUNCS_H_
+#define NETFUNCS_H_
+//
+// netfuncs.h -- some simple functions for serving games over sockets
+//
+//   int  listen_tcp(port, address) -- nonblocking listener on address
+//                                     (loopback only unless given)
+//   int  listen_unix(path)   -- nonblocking listener on a socket file
+//   int  bind_udp(port, address) -- nonblocking UDP socket on address
+//                                   (loopback only unless given)
+//   int  connect_udp(host, port) -- nonblocking UDP socket talking only
+//                                   to host:port
+//
+// All of them return -1 on failure with errno left set.
+//
+
+#include <string>
+
+int  listen_tcp(int port, const std::string &address = "127.0.0.1");
+int  listen_unix(const std::string &path);
+int  bind_udp(int port, const std::string &address = "127.0.0.1");
+int  connect_udp(const std::string &host, int port);
+
+#endif
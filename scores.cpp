@@ -0,0 +1,73 @@
+#include <iostream>
+#include <cstdlib>
+#include <ctime>
+#include <unistd.h>
+#include "Scores.h"
+using namespace std;
+
+/* Usage: snake_scores [-k count] [-p player] [-a player -n score] scores
+ * Shows the best scores in a score file (see SNAKE_SCORES and snake_host
+ * -s), ten by default, or with -p just one player's best. With -a and -n,
+ * records a score first. */
+int main(int argc, char *argv[])
+{
+        int count = 10, score = 0;
+        string player, adding;
+        int opt;
+
+        while ((opt = getopt(argc, argv, "k:p:a:n:")) != -1) {
+                switch (opt) {
+                        case 'k':
+                                count = atoi(optarg);
+                                break;
+                        case 'p':
+                                player = optarg;
+                                break;
+                        case 'a':
+                                adding = optarg;
+                                break;
+                        case 'n':
+                                score = atoi(optarg);
+                                break;
+                        default:
+                                optind = argc + 1;
+                                break;
+                }
+        }
+        if (optind + 1 != argc) {
+                cerr << "Usage: " << argv[0] << " [-k count] [-p player] "
+                     << "[-a player -n score] scores\n";
+                return EXIT_FAILURE;
+        }
+
+        Scores scores;
+        if (!scores.open(argv[optind])) {
+                cerr << "Cannot open scores " << argv[optind] << ".\n";
+                return EXIT_FAILURE;
+        }
+        if (!adding.empty() && !scores.record(adding, score)) {
+                cerr << "Cannot record the score.\n";
+                return EXIT_FAILURE;
+        }
+
+        if (!player.empty()) {
+                Score best;
+                if (!scores.best(player, best)) {
+                        cout << player << " has no scores.\n";
+                        return 0;
+                }
+                cout << best.player << " " << best.score << "\n";
+                return 0;
+        }
+
+        vector<Score> leaders = scores.top(count);
+        for (size_t i = 0; i < leaders.size(); i++) {
+                time_t when = leaders[i].when;
+                char date[32];
+                strftime(date, sizeof(date), "%Y-%m-%d", localtime(&when));
+                cout << i + 1 << ". " << leaders[i].player << " "
+                     << leaders[i].score << " " << date << "\n";
+        }
+
+        return 0;
+}
@@ -0,0 +1,84 @@
+#include <iostream>
+#include <cstdlib>
+#include <ctime>
+#include <unistd.h>
+#include "Arena.h"
+#include "Server.h"
+using namespace std;
+
+/* Usage: snake_server [-p port] [-u socket_path] [-P watch_port]
+ *                     [-U watch_socket_path] [-b address] [-y rows]
+ *                     [-x cols] [-t tick_ms]
+ * With neither -p nor -u given, listens for players on TCP port 4000.
+ * Spectators are only accepted if -P or -U is given. TCP ports are only
+ * opened on the loopback address unless -b gives another (0.0.0.0 for
+ * every interface). */
+int main(int argc, char *argv[])
+{
+        int port = -1, watch_port = -1, rows = 10, cols = 40, tick_ms = 100;
+        string path, watch_path, address = "127.0.0.1";
+        int opt;
+
+        while ((opt = getopt(argc, argv, "p:u:P:U:b:y:x:t:")) != -1) {
+                switch (opt) {
+                        case 'p':
+                                port = atoi(optarg);
+                                break;
+                        case 'u':
+                                path = optarg;
+                                break;
+                        case 'P':
+                                watch_port = atoi(optarg);
+                                break;
+                        case 'U':
+                                watch_path = optarg;
+                                break;
+                        case 'b':
+                                address = optarg;
+                                break;
+                        case 'y':
+                                rows = atoi(optarg);
+                                break;
+                        case 'x':
+                                cols = atoi(optarg);
+                                break;
+                        case 't':
+                                tick_ms = atoi(optarg);
+                                break;
+                        default:
+                                cerr << "Usage: " << argv[0] << " [-p port] "
+                                     << "[-u socket_path] [-P watch_port] "
+                                     << "[-U watch_socket_path] [-b address] "
+                                     << "[-y rows] [-x cols] [-t tick_ms]\n";
+                                return EXIT_FAILURE;
+                }
+        }
+        if (port < 0 && path.empty()) {
+                port = 4000;
+        }
+        if (tick_ms < 1) {
+                tick_ms = 1;
+        }
+
+        Arena arena(rows, cols, time(NULL));
+        Server server(arena, tick_ms);
+        if (port >= 0 && !server.listen_tcp(port, address)) {
+                cerr << "Could not listen on port " << port << ".\n";
+                return EXIT_FAILURE;
+        }
+        if (!path.empty() && !server.listen_unix(path)) {
+                cerr << "Could not listen on " << path << ".\n";
+                return EXIT_FAILURE;
+        }
+        if (watch_port >= 0 && !server.watch_tcp(watch_port, address)) {
+                cerr << "Could not listen on port " << watch_port << ".\n";
+                return EXIT_FAILURE;
+        }
+        if (!watch_path.empty() && !server.watch_unix(watch_path)) {
+                cerr << "Could not listen on " << watch_path << ".\n";
+                return EXIT_FAILURE;
+        }
+        server.run();
+
+        return 0;
+}
@@ -1,10 +1,72 @@
 #include <iostream>
+#include <cstdlib>
+#include "Checkpoint.h"
 #include "Game.h"
+#include "Glyphs.h"
+#include "Level.h"
+#include "Scores.h"
+#include "termfuncs.h"
 using namespace std;
 
+// Seconds between the saves made while playing
+#define SAVE_INTERVAL 5
+
+/* If SNAKE_LEVEL names a level file (see snake_level), the game is played
+ * on that level instead of an empty 10 by 40 board. If SNAKE_FOOD is set,
+ * that many pieces of food are kept on the board instead of one.
+ * If SNAKE_SAVE names a file, the game is saved there every few seconds and
+ * on SIGINT or SIGTERM, and picked up from there when started again.
+ * If SNAKE_SCORES names a file, every score is recorded there (see
+ * snake_scores) under SNAKE_PLAYER, or failing that USER. If SNAKE_REP is
+ * set, the terminal is trusted to understand REP (repeat the last
+ * character), which shortens the borders of wide boards. */
 int main()
 {
         Game snake(10, 40);
+        Level level;
+        const char *level_file = getenv("SNAKE_LEVEL");
+        const char *save_file = getenv("SNAKE_SAVE");
+        const char *food = getenv("SNAKE_FOOD");
+        const char *scores_file = getenv("SNAKE_SCORES");
+        const char *rep = getenv("SNAKE_REP");
+        Scores scores;
+
+        if (level_file != NULL) {
+                if (!level.load(level_file)) {
+                        cerr << "Cannot load level " << level_file << ".\n";
+                        return EXIT_FAILURE;
+                }
+                snake = Game(level);
+        }
+        if (food != NULL && atoi(food) > 0) {
+                snake.set_food_at_once(atoi(food));
+        }
+
+        if (rep != NULL) {
+                snake.set_run_codes(RUN_ERASE | RUN_REPEAT);
+        }
+
+        if (scores_file != NULL) {
+                if (!scores.open(scores_file)) {
+                        cerr << "Cannot open scores " << scores_file << ".\n";
+                        return EXIT_FAILURE;
+                }
+                const char *player = getenv("SNAKE_PLAYER");
+                if (player == NULL) {
+                        player = getenv("USER");
+                }
+                snake.set_scores(&scores, player != NULL ? player : "player");
+        }
+
+        if (save_file == NULL) {
+                snake.run();
+                return 0;
+        }
+
+        Checkpoint checkpoint(save_file, SAVE_INTERVAL);
+        checkpoint.load(snake);
+        snake.set_checkpoint(&checkpoint);
+        catch_interrupts();
         snake.run();
 
         return 0;
@@ -21,11 +21,17 @@ static const string CSI = "\033[";
 //   void screen_attr(string attr)
 //   void screen_bright()
 //   void screen_reset()
+//   Sgr sgr_fg(Color), sgr_bg(Color), sgr_attr(Attr)   (in termfuncs.h)
+//   void screen_append(string &, Sgr)                  (in termfuncs.h)
 //   void place_cursor(int, int);   -- move the cursor to row col
 //   void place_char(char, int, int)  -- move and place
 //   void hide_cursor()
 //   void show_cursor()
 //
+//   void catch_interrupts()  -- SIGINT and SIGTERM no longer exit; they
+//				 just set a flag and interrupt any wait
+//   bool interrupted()       -- true once one of them has arrived
+//
 //   int  random_int(int low, int high)
 //		returns random int in [low, high]
 //		note: if SNAKE_SEED is set then use that for srand
@@ -35,6 +41,11 @@ static const string CSI = "\033[";
 //    int get_screen_cols();
 //    int get_screen_rows();
 //
+// hist: typed Color/Attr escape sequences built at compile time, for
+//       appending to a buffer; the string versions still work.
+// hist: catch_interrupts/interrupted added so a game can save itself on
+//       SIGINT or SIGTERM.  getachar returns '\0' if its read is
+//       interrupted or hits end of file, rather than an unset char.
 // hist: 2015-04-07 MAS:  Bug fix:  
 //                        signal() was returning NULL as the default signal
 //                        handler the first time, so we called it again, which
@@ -67,6 +78,8 @@ static int prev_state_stored = 0;
 
 static bool sigint_handler_set = false;
 static	void (*prev_handler)(int) = NULL;
+static bool deferring_interrupts = false;
+static volatile sig_atomic_t interrupt_seen = 0;
 static inline void ensure_sigint_handled();
 
 //
@@ -91,11 +104,12 @@ char getachar()
 		info.c_lflag &= ~ECHO;
 		info.c_lflag &= ~ICANON;
 		tcsetattr(0, TCSANOW, &info);
-		read(0, &c, 1);
+		if ( read(0, &c, 1) != 1 )
+			c = '\0';
 		tcsetattr(0, TCSANOW, &orig);
 	}
-	else 
-		read(0, &c, 1);
+	else if ( read(0, &c, 1) != 1 )
+		c = '\0';
 	return c;
 }
 //
@@ -161,6 +175,10 @@ void show_cursor()
 
 void on_sigint(int s)
 {
+	if ( deferring_interrupts ) {
+		interrupt_seen = s;
+		return;
+	}
 	cout << std::flush;
 	show_cursor();
 	if ( sigint_handler_set and prev_handler != NULL ){
@@ -178,6 +196,30 @@ static inline void ensure_sigint_handled()
         }
 }
 
+//
+// catch_interrupts
+//  from now on SIGINT and SIGTERM only set a flag for interrupted() to
+//  report, so the program can save its work and exit on its own.  Neither
+//  restarts a blocking read, so getachar() returns when one arrives.
+//
+void catch_interrupts()
+{
+	struct sigaction sa;
+
+	sa.sa_handler = on_sigint;
+	sigemptyset(&sa.sa_mask);
+	sa.sa_flags = 0;
+	sigaction(SIGINT, &sa, NULL);
+	sigaction(SIGTERM, &sa, NULL);
+	sigint_handler_set = true;
+	deferring_interrupts = true;
+}
+
+bool interrupted()
+{
+	return interrupt_seen != 0;
+}
+
 //
 // lookup a string in an array
 //   args: string to find, list of strings, len of list
@@ -264,17 +306,17 @@ int random_int(int lo, int hi)
 
 #include <sys/ioctl.h>
 
-// returns number of rows on the screen
+// returns number of rows on the screen, or 0 if stdout is not a terminal
 int get_screen_rows()
 {
-	struct winsize w;
+	struct winsize w = winsize();
 	ioctl(STDOUT_FILENO, TIOCGWINSZ, &w);
 	return w.ws_row;
 }
-// returns number of cols on the screen
+// returns number of cols on the screen, or 0 if stdout is not a terminal
 int get_screen_cols()
 {
-	struct winsize w;
+	struct winsize w = winsize();
 	ioctl(STDOUT_FILENO, TIOCGWINSZ, &w);
 	return w.ws_col;
 }
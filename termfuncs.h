@@ -13,6 +13,11 @@
 //    int get_screen_rows()  -- returns dimensions of terminal
 //    int get_screen_cols()
 //
+//   Sgr sgr_fg(Color), sgr_bg(Color), sgr_attr(Attr)
+//			 -- escape sequences worked out at compile time;
+//			    join them with +
+//   void screen_append(string &, Sgr) -- add one to a caller's buffer
+//
 
 #include <string>
 
@@ -37,12 +42,58 @@ void screen_attr(string);
 void screen_bright();
 void screen_reset();
 
+//
+// typed versions of the above, for code that draws often: every escape
+// sequence is built by the compiler, and screen_append only copies bytes
+// into a buffer the caller already owns, e.g.
+//
+//	constexpr Sgr warning = sgr_fg(Color::red) + sgr_attr(Attr::bright);
+//	screen_append(out, warning);
+//
+enum class Color { black, red, green, yellow, blue, magenta, cyan, white };
+enum class Attr { reset = 0, bright = 1, dim = 2, underscore = 4,
+		  blink = 5, reverse = 7, hidden = 8 };
+
+struct Sgr {
+	char codes[15];
+	unsigned char length;
+};
+
+constexpr Sgr sgr_code(int num)
+{
+	Sgr s = { { '\033', '[' }, 2 };
+	if ( num >= 10 )
+		s.codes[s.length++] = '0' + num / 10;
+	s.codes[s.length++] = '0' + num % 10;
+	s.codes[s.length++] = 'm';
+	return s;
+}
+constexpr Sgr sgr_fg(Color c) { return sgr_code(30 + (int) c); }
+constexpr Sgr sgr_bg(Color c) { return sgr_code(40 + (int) c); }
+constexpr Sgr sgr_attr(Attr a) { return sgr_code((int) a); }
+
+// joined sequences must fit in codes[]; three of the above always do
+constexpr Sgr operator+(Sgr a, Sgr b)
+{
+	for ( int i = 0; i < b.length; i++ )
+		a.codes[a.length++] = b.codes[i];
+	return a;
+}
+
+inline void screen_append(string &out, const Sgr &s)
+{
+	out.append(s.codes, s.length);
+}
+
 void place_cursor(int, int);
 void place_char(char, int, int);
 
 void hide_cursor();
 void show_cursor();
 
+void catch_interrupts();
+bool interrupted();
+
 int  random_int(int, int);
 void seed_random(int);
 
@@ -0,0 +1,77 @@
+#include <algorithm>
+#include <iostream>
+#include <cstdlib>
+#include <ctime>
+#include <thread>
+#include <unistd.h>
+#include "Tuner.h"
+using namespace std;
+
+/* Usage: snake_tune [-g generations] [-p population] [-n games]
+ *                   [-m moves] [-j threads] [-y rows] [-x cols]
+ *                   [-s seed] [-o file]
+ * Tunes the Autopilot's weights, writing statistics for each generation
+ * and the best weights to the file (tune.txt unless -o is given). */
+int main(int argc, char *argv[])
+{
+        int generations = 20, population = 32, games = 16, moves = 2000;
+        int threads = max(thread::hardware_concurrency(), 1u);
+        int rows = 10, cols = 40;
+        unsigned seed = time(NULL);
+        string file = "tune.txt";
+        int opt;
+
+        while ((opt = getopt(argc, argv, "g:p:n:m:j:y:x:s:o:")) != -1) {
+                switch (opt) {
+                        case 'g':
+                                generations = atoi(optarg);
+                                break;
+                        case 'p':
+                                population = atoi(optarg);
+                                break;
+                        case 'n':
+                                games = atoi(optarg);
+                                break;
+                        case 'm':
+                                moves = atoi(optarg);
+                                break;
+                        case 'j':
+                                threads = atoi(optarg);
+                                break;
+                        case 'y':
+                                rows = atoi(optarg);
+                                break;
+                        case 'x':
+                                cols = atoi(optarg);
+                                break;
+                        case 's':
+                                seed = strtoul(optarg, NULL, 10);
+                                break;
+                        case 'o':
+                                file = optarg;
+                                break;
+                        default:
+                                cerr << "Usage: " << argv[0]
+                                     << " [-g generations] [-p population] "
+                                     << "[-n games] [-m moves] [-j threads] "
+                                     << "[-y rows] [-x cols] [-s seed] "
+                                     << "[-o file]\n";
+                                return EXIT_FAILURE;
+                }
+        }
+        if (generations < 1 || population < 2 || games < 1 || threads < 1) {
+                cerr << "Generations, games and threads must be at least 1, "
+                     << "and the population at least 2.\n";
+                return EXIT_FAILURE;
+        }
+
+        Tuner tuner(threads, rows, cols, games, moves, seed);
+        Weights best;
+        if (!tuner.evolve(generations, population, file, best)) {
+                return EXIT_FAILURE;
+        }
+        cout << "Best weights: food " << best.food << ", space "
+             << best.space << ", tail " << best.tail << "\n";
+
+        return 0;
+}
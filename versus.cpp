@@ -0,0 +1,60 @@
+#include <iostream>
+#include <cstdlib>
+#include <unistd.h>
+#include "Versus.h"
+using namespace std;
+
+/* Usage: snake_versus [-p port] [-b address] [-y rows] [-x cols]
+ *                     [-t tick_ms]
+ *        snake_versus -c host [-p port]
+ * The first form hosts a game and waits for an opponent; the second joins
+ * one. The port defaults to 4002. A host only waits on the loopback
+ * address unless -b gives another (0.0.0.0 for every interface), as
+ * whoever reaches the port first becomes the opponent. */
+int main(int argc, char *argv[])
+{
+        int port = 4002, rows = 10, cols = 40, tick_ms = 150;
+        string host, address = "127.0.0.1";
+        int opt;
+
+        while ((opt = getopt(argc, argv, "c:p:b:y:x:t:")) != -1) {
+                switch (opt) {
+                        case 'c':
+                                host = optarg;
+                                break;
+                        case 'p':
+                                port = atoi(optarg);
+                                break;
+                        case 'b':
+                                address = optarg;
+                                break;
+                        case 'y':
+                                rows = atoi(optarg);
+                                break;
+                        case 'x':
+                                cols = atoi(optarg);
+                                break;
+                        case 't':
+                                tick_ms = atoi(optarg);
+                                break;
+                        default:
+                                cerr << "Usage: " << argv[0] << " [-c host] "
+                                     << "[-p port] [-b address] [-y rows] "
+                                     << "[-x cols] [-t tick_ms]\n";
+                                return EXIT_FAILURE;
+                }
+        }
+        if (tick_ms < 1) {
+                tick_ms = 1;
+        }
+
+        Versus game(tick_ms);
+        if (host.empty() ? !game.host(port, address, rows, cols)
+                         : !game.join(host, port)) {
+                cerr << "Could not start a game on port " << port << ".\n";
+                return EXIT_FAILURE;
+        }
+        game.run();
+
+        return 0;
+}
@@ -0,0 +1,229 @@
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+#include <iostream>
+#include <unistd.h>
+#include "Autopilot.h"
+#include "Game.h"
+#include "Glyphs.h"
+#include "Rng.h"
+#include "Terminal.h"
+using namespace std;
+
+// Longest run check_runs() tries
+#define MAX_RUN 1200
+
+/* csi_length()
+ * Purpose: Measures a control sequence with one number by printing it,
+ *          so the costs in append_run() are checked against something
+ *          worked out another way.
+ * Parameters: n (its number), final (its last character)
+ * Returns: int (its length in bytes)
+ */
+static int csi_length(int n, char final)
+{
+        char sequence[32];
+        return snprintf(sequence, sizeof(sequence), "\033[%d%c", n, final);
+}
+
+/* check_runs()
+ * Purpose: Tries append_run() on every length of run up to MAX_RUN, of a
+ *          space and of a border character, with every set of RunCodes.
+ *          Each must come out as short as the shortest allowed way of
+ *          sending it, never longer than the run, and, drawn on a screen,
+ *          look exactly like the run sent as it is. Unless RUN_SKIP is
+ *          allowed, the screen already has something else on it, so runs
+ *          of spaces have to be drawn over it rather than stepped over.
+ * Parameters: None
+ * Returns: bool (true if every run was right; the first that was not is
+ *          reported)
+ */
+static bool check_runs()
+{
+        const char symbols[] = { ' ', '-' };
+        char sent[MAX_RUN];
+        int y, x;
+
+        for (int codes = 0; codes < 8; codes++) {
+                for (int s = 0; s < 2; s++) {
+                        char symbol = symbols[s];
+                        for (int count = 1; count <= MAX_RUN; count++) {
+                                int best = count;
+                                if (symbol == ' ' && (codes & RUN_SKIP)) {
+                                        best = min(best,
+                                                   csi_length(count, 'C'));
+                                }
+                                if (symbol == ' ' && (codes & RUN_ERASE)) {
+                                        best = min(best,
+                                                   csi_length(count, 'X') +
+                                                   csi_length(count, 'C'));
+                                }
+                                if ((codes & RUN_REPEAT) && count > 1) {
+                                        best = min(best, 1 + csi_length(
+                                                   count - 1, 'b'));
+                                }
+
+                                int length = append_run(sent, symbol, count,
+                                                        codes) - sent;
+                                Terminal literal, coded;
+                                if (!(codes & RUN_SKIP)) {
+                                        string before(count + 1, '@');
+                                        literal.feed(before + "\r");
+                                        coded.feed(before + "\r");
+                                }
+                                literal.feed(string(count, symbol));
+                                bool alike = coded.feed(string(sent, length)) &&
+                                             literal.same(coded, y, x);
+
+                                if (length != best || !alike) {
+                                        cout << "A run of " << count << " '"
+                                             << symbol << "' with codes "
+                                             << codes << " took " << length
+                                             << " bytes (best " << best
+                                             << ") and drew "
+                                             << (alike ? "right" : "wrong")
+                                             << ".\n";
+                                        return false;
+                                }
+                        }
+                }
+        }
+        return true;
+}
+
+/* check_game()
+ * Purpose: Plays a game with the Autopilot (and now and then a random
+ *          key), drawing every move twice: once as it is, and once with
+ *          run codes, on a screen that is cleared from time to time as the
+ *          game's own screen would be. After every move the two screens
+ *          must look exactly alike, and the bytes Game says the codes saved
+ *          must be what they did save.
+ * Parameters: rng (where the board size, food and keys come from), rows,
+ *             cols (largest board), moves (most moves to play), codes
+ *             (RunCodes to draw with)
+ * Returns: bool (true if the drawings matched; the first that did not is
+ *          reported)
+ */
+static bool check_game(Rng &rng, int rows, int cols, int moves, int codes)
+{
+        Weights weights = { 1.0, 1.0, 1.0 };
+        Autopilot pilot(weights);
+        Game game(2 + rng.below(rows - 1), 2 + rng.below(cols - 1));
+        game.seed(rng.next());
+        game.set_food_at_once(1 + rng.below(4));
+        game.start();
+        game.begin("wasd"[rng.below(4)]);
+
+        Terminal literal, coded;
+        string plain, short_form;
+        int y, x;
+
+        for (int i = 0; i <= moves && !game.over(); i++) {
+                if (i > 0) {
+                        game.steer(rng.below(8) == 0 ? "wasd"[rng.below(4)]
+                                                     : pilot.choose(game));
+                        game.step();
+                }
+
+                plain.clear();
+                game.set_run_codes(0);
+                game.render(plain);
+
+                if (i == 0 || rng.below(32) == 0) {
+                        coded.clear();
+                        game.screen_cleared();
+                }
+                short_form.clear();
+                unsigned long long before = game.bytes_saved();
+                game.set_run_codes(codes);
+                game.render(short_form);
+                unsigned long long saved = game.bytes_saved() - before;
+
+                bool drawn = literal.feed(plain) && coded.feed(short_form);
+                bool alike = drawn && literal.same(coded, y, x);
+                if (!alike || saved != plain.size() - short_form.size()) {
+                        cout << "Move " << i << " of a " << game.height()
+                             << "x" << game.width() << " game with codes "
+                             << codes << ": ";
+                        if (!drawn) {
+                                cout << "sent something unknown.\n";
+                        } else if (!alike && y >= 0) {
+                                cout << "row " << y << ", column " << x
+                                     << " differs.\n";
+                        } else if (!alike) {
+                                cout << "the cursor ends up elsewhere.\n";
+                        } else {
+                                cout << "saved " << saved << " bytes but "
+                                     << "the drawing was "
+                                     << plain.size() - short_form.size()
+                                     << " shorter.\n";
+                        }
+                        return false;
+                }
+        }
+        return true;
+}
+
+/* Usage: snake_vt [-n games] [-y rows] [-x cols] [-m moves] [-s seed]
+ * Checks that drawing with run codes (see RunCodes in Glyphs.h) shows
+ * exactly what drawing every character does, on a model terminal (see
+ * Terminal): first every run append_run() can be asked for, then the
+ * frames of random games drawn each way. Exits with 1 on the first
+ * difference. */
+int main(int argc, char *argv[])
+{
+        int games = 50, rows = 24, cols = 80, moves = 1000;
+        uint64_t seed = time(NULL);
+        int opt;
+
+        while ((opt = getopt(argc, argv, "n:y:x:m:s:")) != -1) {
+                switch (opt) {
+                        case 'n':
+                                games = atoi(optarg);
+                                break;
+                        case 'y':
+                                rows = atoi(optarg);
+                                break;
+                        case 'x':
+                                cols = atoi(optarg);
+                                break;
+                        case 'm':
+                                moves = atoi(optarg);
+                                break;
+                        case 's':
+                                seed = strtoull(optarg, NULL, 10);
+                                break;
+                        default:
+                                cerr << "Usage: " << argv[0] << " [-n games] "
+                                     << "[-y rows] [-x cols] [-m moves] "
+                                     << "[-s seed]\n";
+                                return EXIT_FAILURE;
+                }
+        }
+        if (rows < 2 || cols < 2) {
+                cerr << "Invalid Dimensions. Please choose dimensions "
+                     << "of size 2 or greater.\n";
+                return EXIT_FAILURE;
+        }
+
+        if (!check_runs()) {
+                return 1;
+        }
+        cout << "Every run up to " << MAX_RUN << " is sent right.\n";
+
+        const int code_sets[] = { RUN_ERASE, RUN_REPEAT,
+                                  RUN_ERASE | RUN_REPEAT };
+        Rng rng(seed);
+        for (int i = 0; i < games; i++) {
+                if (!check_game(rng, rows, cols, moves, code_sets[i % 3])) {
+                        cout << "Seed " << seed << ", game " << i << ".\n";
+                        return 1;
+                }
+        }
+        cout << "Seed " << seed << ": " << games << " games drawn alike with "
+             << "and without run codes.\n";
+
+        return 0;
+}
+
+#undef MAX_RUN
@@ -0,0 +1,86 @@
+#include <iostream>
+#include <cstdlib>
+#include <cstdio>
+#include <ctime>
+#include <unistd.h>
+#include <vector>
+#include "Autopilot.h"
+#include "Game.h"
+#include "Wall.h"
+#include "termfuncs.h"
+using namespace std;
+
+/* Usage: snake_wall [-n games] [-y rows] [-x cols] [-t tick_ms]
+ *                   [-w food,space,tail]
+ * Plays a number of games by Autopilot and shows them all at once on a
+ * Wall, restarting each game as it ends, until interrupted. The weights
+ * can be the ones snake_tune found. */
+int main(int argc, char *argv[])
+{
+        int count = 16, rows = 10, cols = 40, tick_ms = 100;
+        Weights weights = { 1.0, 1.0, 1.0 };
+        int opt;
+
+        while ((opt = getopt(argc, argv, "n:y:x:t:w:")) != -1) {
+                switch (opt) {
+                        case 'n':
+                                count = atoi(optarg);
+                                break;
+                        case 'y':
+                                rows = atoi(optarg);
+                                break;
+                        case 'x':
+                                cols = atoi(optarg);
+                                break;
+                        case 't':
+                                tick_ms = atoi(optarg);
+                                break;
+                        case 'w':
+                                sscanf(optarg, "%lf,%lf,%lf", &weights.food,
+                                       &weights.space, &weights.tail);
+                                break;
+                        default:
+                                cerr << "Usage: " << argv[0] << " [-n games] "
+                                     << "[-y rows] [-x cols] [-t tick_ms] "
+                                     << "[-w food,space,tail]\n";
+                                return EXIT_FAILURE;
+                }
+        }
+        if (count < 1) {
+                cerr << "There must be at least one game.\n";
+                return EXIT_FAILURE;
+        }
+
+        vector<Game> games(count, Game(rows, cols));
+        Autopilot pilot(weights);
+        Wall wall;
+        unsigned seed = time(NULL);
+        for (int i = 0; i < count; i++) {
+                games[i].seed(seed + i);
+                games[i].start();
+                wall.add(&games[i]);
+        }
+
+        catch_interrupts();
+        hide_cursor();
+        while (!interrupted()) {
+                for (int i = 0; i < count; i++) {
+                        if (games[i].over()) {
+                                games[i].reset();
+                                games[i].start();
+                                continue;
+                        }
+                        games[i].steer(pilot.choose(games[i]));
+                        games[i].step();
+                }
+                wall.refresh();
+                usleep(tick_ms * 1000);
+        }
+
+        screen_clear();
+        show_cursor();
+        screen_reset();
+        cout << flush;
+
+        return 0;
+}